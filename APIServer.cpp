@@ -1,12 +1,18 @@
 #define _WIN32_WINNT 0x0A00
 #include "APIServer.h"
 #include "FirebaseClient.h"
+#include "GuardianAPI.h"
+#include "NewsIndex.h"
+#include "CircuitBreaker.h"
+#include "EpochReclaimer.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <thread>
 #include <chrono>
 #include <ctime>
+#include <cstring>
+#include <unordered_set>
 #include "httplib.h"
 // Simple JSON helper functions
 std::string escapeJson(const std::string& str) {
@@ -43,19 +49,261 @@ std::string createJsonError(const std::string& error) {
 }
 
 APIServer::APIServer(int port, const std::string& firebaseUrl, const std::string& firebaseKey,
-                     const std::string& groqKey, const std::string& groqModel)
-    : port(port), running(false) {
+                     const std::string& groqKey, const std::string& groqModel,
+                     const ServerOptions& opts)
+    : options(opts), port(port), running(false),
+      snapshotStopping(false), snapshotLoadMs(0), snapshotsWritten(0),
+      customResponsesReady(false), customResponseLoadMs(0) {
     chatbot = std::unique_ptr<Chatbot>(new Chatbot());
     firebaseClient = std::unique_ptr<FirebaseClient>(new FirebaseClient(firebaseUrl, firebaseKey));
     
+    // Requests that block on upstream (chats, history, responses) may never
+    // occupy the reserved workers, so health/metrics always get a thread
+    int workerLimit = std::max(options.threadPoolSize - options.reservedWorkers, 1);
+    workerAdmission = std::unique_ptr<AdmissionController>(new AdmissionController(workerLimit));
+    chatAdmission = std::unique_ptr<AdmissionController>(
+        new AdmissionController(std::max(std::min(options.maxInflightChats, workerLimit), 1)));
+    
+    NewsCache::shared().configure(options.news);
+    // Fetched news goes to /news/articles, where loadNewsIndex finds it next start
+    FirebaseClient* firebase = firebaseClient.get();
+    NewsCache::shared().setStore([firebase](const std::vector<NewsCache::Article>& articles) {
+        firebase->storeNewsArticles(articles);
+    });
+    
     // Initialize AI if API key is provided
     if (!groqKey.empty()) {
         std::string model = groqModel.empty() ? "llama-3.3-70b-versatile" : groqModel;
         chatbot->initializeAI(groqKey, model);
+        chatbot->configureResponseCache(options.responseCacheEntries, options.responseCacheTtlSec);
+        SemanticCache::Options semantic = options.semanticCache;
+        semantic.ttlSec = options.responseCacheTtlSec;
+        chatbot->configureSemanticCache(semantic);
+        chatbot->configureContextWindow(options.contextTokenBudget, options.contextCompactTokens);
+        chatbot->setHedging(options.hedgeRequests);
+    }
+    
+    loadSnapshot();
+    openMessageLog();
+    if (!options.snapshotPath.empty() && options.snapshotIntervalSec > 0) {
+        snapshotThread = std::thread(&APIServer::snapshotLoop, this);
+    }
+    // Chats are served from the built-in/snapshot map until this lands;
+    // the news index is seeded on the same thread right after
+    responseLoader = std::thread([this]() {
+        loadCustomResponses();
+        loadNewsIndex();
+    });
+    // Likewise the corpus, which is read and indexed on its watcher thread
+    if (!options.responseCorpusPath.empty()) {
+        chatbot->watchResponseCorpus(options.responseCorpusPath);
+    }
+}
+
+APIServer::~APIServer() {
+    stop();
+}
+
+// Maps the last snapshot and restores the small, bounded parts (response map,
+// recent history) right away; AI sessions are read from the mapping on first use
+void APIServer::loadSnapshot() {
+    if (options.snapshotPath.empty()) return;
+    
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<SnapshotView> view = std::make_shared<SnapshotView>();
+    if (!view->open(options.snapshotPath)) {
+        std::cerr << "[Snapshot] None found at " << options.snapshotPath << ", starting cold" << std::endl;
+        return;
+    }
+    
+    chatbot->restoreResponses(view->responses());
+    chatbot->restoreHistory(view->messages());
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        snapshotView = view;
+        for (const auto& userId : view->clearedUsers()) clearedUsers.insert(userId);
+    }
+    chatbot->setSessionSeed([this](const std::string& userId, GroqClient::Turns& turns, std::string& summary) {
+        std::shared_ptr<SnapshotView> current;
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            if (clearedUsers.count(userId)) return false;
+            current = snapshotView;
+        }
+        const snapshot::SessionRec* rec = current ? current->findSession(userId) : nullptr;
+        if (!rec) return false;
+        turns = current->turnsOf(*rec);
+        summary = current->str(rec->summary);
+        return true;
+    });
+    
+    snapshotLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[Snapshot] Loaded " << view->sessionCount() << " sessions (" << view->bytes()
+              << " bytes, up to LSN " << view->walLsn() << ") in " << snapshotLoadMs.load() << " ms" << std::endl;
+}
+
+void APIServer::writeSnapshot() {
+    if (options.snapshotPath.empty()) return;
+    
+    // Taken before the state is read: replaying from here may repeat a
+    // turn that raced the snapshot, but never misses one
+    uint64_t walLsn = messageLog ? messageLog->getStats().durableLsn : 0;
+    std::shared_ptr<SnapshotView> previous;
+    std::unordered_set<std::string> cleared;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        previous = snapshotView;
+        cleared = clearedUsers;
+    }
+    
+    SnapshotWriter writer;
+    std::unordered_set<std::string> live;
+    chatbot->exportSessions([&](const std::string& userId, const GroqClient::Turns& turns, const std::string& summary) {
+        writer.addSession(userId, summary, turns);
+        live.insert(userId);
+    });
+    // Sessions nobody touched since the last snapshot are carried over as-is,
+    // unless they were cleared since
+    if (previous) {
+        for (size_t i = 0; i < previous->sessionCount(); i++) {
+            const snapshot::SessionRec& rec = previous->sessionAt(i);
+            std::string userId = previous->str(rec.userId);
+            if (live.count(userId) == 0 && cleared.count(userId) == 0) {
+                writer.addSession(userId, previous->str(rec.summary), previous->turnsOf(rec));
+            }
+        }
+    }
+    for (const auto& msg : chatbot->getHistoryMessages()) {
+        writer.addMessage(msg);
+    }
+    for (const auto& entry : chatbot->getResponses()) {
+        writer.addResponse(entry);
+    }
+    // Users cleared while sessions were exported may have been written with
+    // their old context; the file says to ignore those sessions
+    std::unordered_set<std::string> racing;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        for (const auto& userId : clearedUsers) {
+            if (cleared.count(userId) == 0) racing.insert(userId);
+        }
+    }
+    for (const auto& userId : racing) {
+        writer.addClearedUser(userId);
+    }
+    
+    if (!writer.write(options.snapshotPath, walLsn)) return;
+    
+    std::shared_ptr<SnapshotView> view = std::make_shared<SnapshotView>();
+    if (view->open(options.snapshotPath)) {
+        // The new file no longer holds the old context of users cleared before it
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        snapshotView = view;
+        for (const auto& userId : cleared) {
+            if (racing.count(userId) == 0) clearedUsers.erase(userId);
+        }
+    }
+    snapshotsWritten++;
+    if (messageLog) messageLog->retainAfter(walLsn);
+    std::cerr << "[Snapshot] Wrote " << writer.sessionCount() << " sessions up to LSN " << walLsn << std::endl;
+}
+
+void APIServer::snapshotLoop() {
+    std::unique_lock<std::mutex> lock(snapshotMutex);
+    while (!snapshotStopping) {
+        snapshotCv.wait_for(lock, std::chrono::seconds(options.snapshotIntervalSec));
+        if (snapshotStopping) break;
+        lock.unlock();
+        writeSnapshot();
+        lock.lock();
+    }
+}
+
+// Seeds the news index with the articles stored by earlier runs, so keyword
+// news answers survive a restart without rescanning Firebase per search
+void APIServer::loadNewsIndex() {
+    auto start = std::chrono::steady_clock::now();
+    size_t added = 0;
+    bool ok = firebaseClient->loadNewsArticles(
+        [&](const std::string& title, const std::string& url, const std::string& section, const std::string& date) {
+            if (NewsIndex::shared().add(title, url, section, date)) added++;
+        });
+    if (!ok) {
+        std::cerr << "[News] Index seed failed, indexing fresh Guardian fetches only" << std::endl;
+        return;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[News] Indexed " << added << " stored articles in " << ms << " ms" << std::endl;
+}
+
+// One request for every user's responses instead of one per user; the
+// overlays are built across cores and installed a shard at a time
+void APIServer::loadCustomResponses() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<UserResponse> entries;
+    std::unordered_set<std::string> users;
+    bool ok = firebaseClient->loadAllUserResponses(
+        [&](const std::string& userId, const std::string& keyword, const std::string& response) {
+            entries.push_back({userId, keyword, {response}});
+            users.insert(userId);
+        });
+    if (!ok) {
+        std::cerr << "[Responses] Bulk load failed, serving built-in and snapshot responses" << std::endl;
+        return;
     }
+    
+    int threads = (int)std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    chatbot->mergeUserResponses(entries, threads);
+    customResponseLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    customResponsesReady = true;
+    std::cerr << "[Responses] Loaded " << entries.size() << " custom responses for " << users.size()
+              << " users in " << customResponseLoadMs << " ms" << std::endl;
 }
 
-APIServer::~APIServer() = default;
+// Replays the log into memory (warm start) and ships anything Firebase has
+// not acknowledged yet. Keys derive from the LSN, so re-sending is harmless.
+void APIServer::openMessageLog() {
+    if (options.wal.directory.empty()) return;
+    
+    messageLog = std::unique_ptr<MessageLog>(new MessageLog(options.wal));
+    uint64_t snapshotLsn = 0;
+    if (!options.snapshotPath.empty()) {
+        snapshotLsn = snapshotView ? snapshotView->walLsn() : 0;
+        messageLog->retainAfter(snapshotLsn);
+    }
+    Chatbot* bot = chatbot.get();
+    if (!messageLog->open([this, bot](const MessageLog::Record& rec) {
+            if (rec.isClear()) {
+                markCleared(rec.userId);
+            } else {
+                bot->restoreMessage(rec.userId, rec.message);
+            }
+        }, snapshotLsn)) {
+        std::cerr << "[WAL] Disabled, falling back to direct Firebase writes" << std::endl;
+        messageLog.reset();
+        return;
+    }
+    
+    FirebaseClient* firebase = firebaseClient.get();
+    messageLog->startReplication([firebase](const std::vector<MessageLog::Record>& batch,
+                                            std::function<void(MessageLog::ShipResult)> shipped) {
+        auto done = [shipped](bool ok, bool retriable) {
+            shipped(ok ? MessageLog::SHIPPED : retriable ? MessageLog::RETRY : MessageLog::REJECTED);
+        };
+        // A clear is replayed in log order, so no earlier message lands after it
+        if (batch.front().isClear()) {
+            firebase->deleteMessagesAsync(batch.front().userId, done);
+            return;
+        }
+        std::vector<std::pair<std::string, Message>> keyed;
+        for (const auto& rec : batch) {
+            char key[32];
+            snprintf(key, sizeof(key), "wal-%020llu", (unsigned long long)rec.lsn);
+            keyed.push_back({key, rec.message});
+        }
+        firebase->patchMessagesAsync(batch.front().userId, keyed, done);
+    });
+}
 
 std::string APIServer::extractUserId(const APIRequest& req) const {
     // Extract from headers or query params
@@ -68,6 +316,18 @@ std::string APIServer::extractUserId(const APIRequest& req) const {
     return "default";  // Default user if not provided
 }
 
+// Largest history page served in one request
+static const int kMaxHistoryLimit = 500;
+
+// The id becomes a Firebase path segment, where these characters are refused
+bool APIServer::isValidUserId(const std::string& userId) {
+    if (userId.empty() || userId.size() > 128) return false;
+    for (char c : userId) {
+        if ((unsigned char)c < 0x20 || c == 0x7F || std::strchr(".#$[]/", c)) return false;
+    }
+    return true;
+}
+
 std::string APIServer::parseJsonField(const std::string& json, const std::string& field) const {
     std::string searchStr = "\"" + field + "\":\"";
     size_t pos = json.find(searchStr);
@@ -97,14 +357,46 @@ APIResponse APIServer::handleChat(const APIRequest& req) {
     }
     
     std::string userId = extractUserId(req);
+    if (!isValidUserId(userId)) {
+        return errorResponse(400, "Invalid user id");
+    }
     std::string userInput = parseJsonField(req.body, "message");
     
     if (userInput.empty()) {
         return errorResponse(400, "Missing 'message' field in request body");
     }
     
+    // Shed load early instead of pinning another worker on a slow AI call
+    AdmissionTicket ticket(*chatAdmission);
+    if (!ticket.isGranted()) {
+        return busyResponse();
+    }
+    AdmissionTicket worker(*workerAdmission);
+    if (!worker.isGranted()) {
+        return busyResponse();
+    }
+    
+    // "Cache-Control: no-cache" bypasses the AI response cache for this request
+    bool allowCache = true;
+    auto cacheControl = req.headers.find("Cache-Control");
+    if (cacheControl != req.headers.end() && cacheControl->second.find("no-cache") != std::string::npos) {
+        allowCache = false;
+    }
+    
+    // The deadline starts here; "X-Timeout-Ms" may shorten (never extend) it
+    long long deadlineMs = options.chatDeadlineMs;
+    auto timeoutHeader = req.headers.find("X-Timeout-Ms");
+    if (timeoutHeader != req.headers.end()) {
+        try {
+            deadlineMs = std::min(deadlineMs, std::max(1LL, std::stoll(timeoutHeader->second)));
+        } catch (const std::exception&) {
+            // Ignore malformed values
+        }
+    }
+    GroqClient::Clock::time_point deadline = GroqClient::Clock::now() + std::chrono::milliseconds(deadlineMs);
+    
     // Get bot response
-    std::string botResponse = chatbot->respond(userInput);
+    std::string botResponse = chatbot->respond(userInput, userId, allowCache, deadline);
     
     // Save to Firebase
     time_t now = time(0);
@@ -115,8 +407,11 @@ APIResponse APIServer::handleChat(const APIRequest& req) {
     Message userMsg(userInput, "user", timestamp);
     Message botMsg(botResponse, "bot", timestamp);
     
-    firebaseClient->saveMessage(userMsg, userId);
-    firebaseClient->saveMessage(botMsg, userId);
+    // Durable locally before we answer; Firebase gets it from the log's replicator.
+    // If the log cannot write, save straight to Firebase instead
+    if (!messageLog || messageLog->append(userId, {userMsg, botMsg}) == 0) {
+        firebaseClient->saveMessagesAsync({userMsg, botMsg}, userId);
+    }
     
     // Create response JSON
     std::ostringstream json;
@@ -130,11 +425,29 @@ APIResponse APIServer::handleHistory(const APIRequest& req) {
         return errorResponse(405, "Method not allowed. Use GET.");
     }
     
+    AdmissionTicket worker(*workerAdmission);
+    if (!worker.isGranted()) {
+        return busyResponse();
+    }
+    
     std::string userId = extractUserId(req);
+    if (!isValidUserId(userId)) {
+        return errorResponse(400, "Invalid user id");
+    }
     int limit = 50;
     
     if (req.queryParams.find("limit") != req.queryParams.end()) {
-        limit = std::stoi(req.queryParams.at("limit"));
+        const std::string& value = req.queryParams.at("limit");
+        size_t parsed = 0;
+        try {
+            limit = std::stoi(value, &parsed);
+        } catch (const std::exception&) {
+            parsed = 0;
+        }
+        if (parsed == 0 || parsed != value.size() || limit <= 0) {
+            return errorResponse(400, "'limit' must be a positive integer");
+        }
+        limit = std::min(limit, kMaxHistoryLimit);
     }
     
     std::vector<Message> messages = firebaseClient->getMessages(userId, limit);
@@ -158,22 +471,64 @@ APIResponse APIServer::handleClearHistory(const APIRequest& req) {
         return errorResponse(405, "Method not allowed. Use DELETE.");
     }
     
+    AdmissionTicket worker(*workerAdmission);
+    if (!worker.isGranted()) {
+        return busyResponse();
+    }
+    
     std::string userId = extractUserId(req);
+    if (!isValidUserId(userId)) {
+        return errorResponse(400, "Invalid user id");
+    }
+    
+    if (messageLog) {
+        // Firebase is cleared by the replicator once the messages logged
+        // before the clear are shipped; a direct DELETE could be overtaken
+        if (messageLog->appendClear(userId) == 0) {
+            return errorResponse(500, "Failed to clear history");
+        }
+        markCleared(userId);
+        return jsonResponse(200, "History cleared successfully");
+    }
     
     if (firebaseClient->clearUserHistory(userId)) {
-        chatbot->clearHistory();
+        markCleared(userId);
         return jsonResponse(200, "History cleared successfully");
     }
     
     return errorResponse(500, "Failed to clear history");
 }
 
+APIResponse APIServer::busyResponse() const {
+    APIResponse busy = errorResponse(503, "Server is busy. Please retry shortly.");
+    busy.headers["Retry-After"] = "1";
+    return busy;
+}
+
+// Drops the user's AI context and keeps the snapshot's copy of it from
+// seeding a new session or being carried into the next snapshot
+void APIServer::markCleared(const std::string& userId) {
+    if (!options.snapshotPath.empty()) {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        clearedUsers.insert(userId);
+    }
+    chatbot->clearUserContext(userId);
+}
+
 APIResponse APIServer::handleAddResponse(const APIRequest& req) {
     if (req.method != "POST") {
         return errorResponse(405, "Method not allowed. Use POST.");
     }
     
+    AdmissionTicket worker(*workerAdmission);
+    if (!worker.isGranted()) {
+        return busyResponse();
+    }
+    
     std::string userId = extractUserId(req);
+    if (!isValidUserId(userId)) {
+        return errorResponse(400, "Invalid user id");
+    }
     std::string keyword = parseJsonField(req.body, "keyword");
     std::string response = parseJsonField(req.body, "response");
     
@@ -181,7 +536,7 @@ APIResponse APIServer::handleAddResponse(const APIRequest& req) {
         return errorResponse(400, "Missing 'keyword' or 'response' field");
     }
     
-    chatbot->addCustomResponse(keyword, response);
+    chatbot->addCustomResponse(keyword, response, userId);
     
     if (firebaseClient->saveUserResponse(keyword, response, userId)) {
         return jsonResponse(200, "Custom response added successfully");
@@ -207,6 +562,155 @@ APIResponse APIServer::handleHealth(const APIRequest& req) {
     return jsonResponse(200, "Server is healthy", json.str());
 }
 
+APIResponse APIServer::handleMetrics(const APIRequest& req) {
+    if (req.method != "GET") {
+        return errorResponse(405, "Method not allowed. Use GET.");
+    }
+    
+    std::ostringstream json;
+    json << "{\"server\":{\"threadPoolSize\":" << options.threadPoolSize
+         << ",\"maxQueuedConnections\":" << options.maxQueuedConnections
+         << ",\"reservedWorkers\":" << options.reservedWorkers << "}"
+         << ",\"chatAdmission\":{\"limit\":" << chatAdmission->getLimit()
+         << ",\"inflight\":" << chatAdmission->getInflight()
+         << ",\"admitted\":" << chatAdmission->getAdmitted()
+         << ",\"rejected\":" << chatAdmission->getRejected() << "}"
+         << ",\"workerAdmission\":{\"limit\":" << workerAdmission->getLimit()
+         << ",\"inflight\":" << workerAdmission->getInflight()
+         << ",\"admitted\":" << workerAdmission->getAdmitted()
+         << ",\"rejected\":" << workerAdmission->getRejected() << "}"
+         << ",\"upstream\":{\"inflight\":" << AsyncHttp::shared().getInflight()
+         << ",\"completed\":" << AsyncHttp::shared().getCompleted() << "}";
+    
+    ResponseCache::Stats cache = chatbot->getResponseCacheStats();
+    long long lookups = cache.hits + cache.misses;
+    json << ",\"responseCache\":{\"entries\":" << cache.entries
+         << ",\"hits\":" << cache.hits
+         << ",\"misses\":" << cache.misses
+         << ",\"hitRate\":" << (lookups > 0 ? (double)cache.hits / lookups : 0.0)
+         << ",\"evictions\":" << cache.evictions
+         << ",\"savedLatencyMs\":" << cache.savedLatencyMs
+         << ",\"memoryBytes\":" << cache.memoryBytes << "}";
+    
+    SemanticCache::Stats semantic = chatbot->getSemanticCacheStats();
+    long long semanticLookups = semantic.hits + semantic.misses;
+    json << ",\"semanticCache\":{\"entries\":" << semantic.entries
+         << ",\"hits\":" << semantic.hits
+         << ",\"misses\":" << semantic.misses
+         << ",\"hitRate\":" << (semanticLookups > 0 ? (double)semantic.hits / semanticLookups : 0.0)
+         << ",\"evictions\":" << semantic.evictions
+         << ",\"trained\":" << (semantic.trained ? "true" : "false")
+         << ",\"lookupP50Us\":" << semantic.lookupP50Us
+         << ",\"lookupP95Us\":" << semantic.lookupP95Us
+         << ",\"savedLatencyMs\":" << semantic.savedLatencyMs
+         << ",\"memoryBytes\":" << semantic.memoryBytes << "}"
+         << ",\"aiSessions\":" << chatbot->getAISessionCount();
+    
+    GroqClient::HedgeStats hedge = chatbot->getHedgeStats();
+    json << ",\"hedging\":{\"p95Ms\":" << hedge.p95Ms
+         << ",\"hedged\":" << hedge.hedged
+         << ",\"hedgeWins\":" << hedge.hedgeWins
+         << ",\"deadlineExceeded\":" << hedge.deadlineExceeded << "}";
+    
+    json << ",\"circuitBreakers\":{";
+    bool firstBreaker = true;
+    for (CircuitBreaker* breaker : CircuitBreaker::all()) {
+        CircuitBreaker::Stats b = breaker->getStats();
+        json << (firstBreaker ? "" : ",") << "\"" << breaker->getName() << "\":{"
+             << "\"state\":\"" << CircuitBreaker::stateName(b.state) << "\""
+             << ",\"calls\":" << b.calls
+             << ",\"failures\":" << b.failures
+             << ",\"failureRate\":" << b.failureRate
+             << ",\"rejected\":" << b.rejected
+             << ",\"trips\":" << b.trips << "}";
+        firstBreaker = false;
+    }
+    json << "}";
+    
+    if (messageLog) {
+        MessageLog::Stats wal = messageLog->getStats();
+        json << ",\"wal\":{\"lastLsn\":" << wal.lastLsn
+             << ",\"durableLsn\":" << wal.durableLsn
+             << ",\"replicatedLsn\":" << wal.replicatedLsn
+             << ",\"backlog\":" << wal.backlog
+             << ",\"segments\":" << wal.segments
+             << ",\"records\":" << wal.records
+             << ",\"fsyncs\":" << wal.fsyncs
+             << ",\"writeErrors\":" << wal.writeErrors
+             << ",\"rejected\":" << wal.rejected << "}";
+    }
+    
+    if (!options.snapshotPath.empty()) {
+        std::shared_ptr<SnapshotView> view;
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            view = snapshotView;
+        }
+        json << ",\"snapshot\":{\"walLsn\":" << (view ? view->walLsn() : 0)
+             << ",\"sessions\":" << (view ? view->sessionCount() : 0)
+             << ",\"bytes\":" << (view ? view->bytes() : 0)
+             << ",\"loadMs\":" << snapshotLoadMs.load()
+             << ",\"written\":" << snapshotsWritten.load() << "}";
+    }
+    
+    bool responsesReady = customResponsesReady;
+    UserResponses::Stats custom = chatbot->getCustomResponseStats();
+    EpochReclaimer::Stats epochs = EpochReclaimer::shared().getStats();
+    json << ",\"responses\":{\"builtIn\":" << chatbot->getBuiltInResponseCount()
+         << ",\"customKeys\":" << chatbot->getCustomResponseCount()
+         << ",\"customUsers\":" << chatbot->getCustomResponseUsers()
+         << ",\"publishes\":" << custom.publishes
+         << ",\"writes\":" << custom.writes
+         << ",\"retiredPending\":" << epochs.pending
+         << ",\"reclaimed\":" << epochs.reclaimed
+         << ",\"fuzzyMatches\":" << chatbot->getFuzzyMatchCount()
+         << ",\"bulkLoaded\":" << (responsesReady ? "true" : "false")
+         << ",\"loadMs\":" << (responsesReady ? customResponseLoadMs : 0.0) << "}";
+    
+    if (!options.responseCorpusPath.empty()) {
+        ResponseCorpus::Stats corpus = chatbot->getCorpusStats();
+        json << ",\"corpus\":{\"path\":\"" << escapeJson(corpus.path) << "\""
+             << ",\"keys\":" << corpus.keys
+             << ",\"version\":" << corpus.version
+             << ",\"failures\":" << corpus.failures
+             << ",\"badLines\":" << corpus.badLines
+             << ",\"loadMs\":" << corpus.loadMs << "}";
+    }
+    
+    IntentRouter::Stats routing = chatbot->getIntentStats();
+    json << ",\"intents\":{\"routeP50Us\":" << routing.routeP50Us
+         << ",\"routeP95Us\":" << routing.routeP95Us;
+    for (const auto& intent : routing.intents) {
+        json << ",\"" << intent.name << "\":{\"triggered\":" << intent.triggered
+             << ",\"handled\":" << intent.handled
+             << ",\"declined\":" << intent.declined
+             << ",\"p50Ms\":" << intent.p50Ms
+             << ",\"p95Ms\":" << intent.p95Ms << "}";
+    }
+    json << "}";
+    
+    json << ",\"singleFlight\":{"
+         << "\"firebaseReads\":{\"executed\":" << firebaseClient->getReadsExecuted()
+         << ",\"coalesced\":" << firebaseClient->getReadsCoalesced() << "}"
+         << ",\"groq\":{\"executed\":" << GroqClient::upstreamFlight().getExecuted()
+         << ",\"coalesced\":" << GroqClient::upstreamFlight().getCoalesced() << "}"
+         << ",\"news\":{\"executed\":" << GuardianAPI::fetchFlight().getExecuted()
+         << ",\"coalesced\":" << GuardianAPI::fetchFlight().getCoalesced() << "}}";
+    
+    NewsCache::Stats news = NewsCache::shared().getStats();
+    json << ",\"newsCache\":{\"entries\":" << news.entries
+         << ",\"hits\":" << news.hits
+         << ",\"staleHits\":" << news.staleHits
+         << ",\"misses\":" << news.misses
+         << ",\"refreshes\":" << news.refreshes
+         << ",\"refreshFailures\":" << news.refreshFailures
+         << ",\"evictions\":" << news.evictions << "}"
+         << ",\"newsIndex\":{\"articles\":" << NewsIndex::shared().size()
+         << ",\"memoryBytes\":" << NewsIndex::shared().memoryBytes() << "}}";
+    
+    return jsonResponse(200, "Metrics retrieved", json.str());
+}
+
 APIResponse APIServer::processRequest(const APIRequest& req) {
     // Route to appropriate handler
     if (req.path == "/api/chat" || req.path == "/api/chat/") {
@@ -221,6 +725,8 @@ APIResponse APIServer::processRequest(const APIRequest& req) {
         return handleStatistics(req);
     } else if (req.path == "/api/health" || req.path == "/api/health/") {
         return handleHealth(req);
+    } else if (req.path == "/api/metrics" || req.path == "/api/metrics/") {
+        return handleMetrics(req);
     } else {
         return errorResponse(404, "Endpoint not found");
     }
@@ -230,6 +736,15 @@ APIResponse APIServer::processRequest(const APIRequest& req) {
 void APIServer::start() {
     httplib::Server svr;
 
+    // Worker pool and connection limits
+    svr.new_task_queue = [this] {
+        return new httplib::ThreadPool(options.threadPoolSize, options.maxQueuedConnections);
+    };
+    svr.set_keep_alive_max_count(options.keepAliveMaxCount);
+    svr.set_keep_alive_timeout(options.keepAliveTimeoutSec);
+    svr.set_read_timeout(options.readTimeoutSec, 0);
+    svr.set_write_timeout(options.writeTimeoutSec, 0);
+
     // POST /api/chat
     svr.Post("/api/chat", [&](const httplib::Request& req, httplib::Response& res) {
         std::cout << "📥 Incoming: [POST] /api/chat | Body: " << req.body << std::endl;
@@ -245,6 +760,9 @@ void APIServer::start() {
         APIResponse apiResp = processRequest(apiReq);
         res.set_content(apiResp.body, "application/json");
         res.status = apiResp.statusCode;
+        for (auto& h : apiResp.headers) {
+            if (h.first != "Content-Type") res.set_header(h.first, h.second);
+        }
     });
 
 
@@ -321,6 +839,17 @@ void APIServer::start() {
         res.status = apiResp.statusCode;
     });
 
+    // GET /api/metrics
+    svr.Get("/api/metrics", [&](const httplib::Request&, httplib::Response& res) {
+        APIRequest apiReq;
+        apiReq.method = "GET";
+        apiReq.path = "/api/metrics";
+
+        APIResponse apiResp = processRequest(apiReq);
+        res.set_content(apiResp.body, "application/json");
+        res.status = apiResp.statusCode;
+    });
+
     // OPTIONS handler for CORS preflight requests
     svr.Options(R"(.*)", [](const httplib::Request&, httplib::Response& res) {
         res.status = 204; // No Content
@@ -330,11 +859,16 @@ void APIServer::start() {
     svr.set_post_routing_handler([](const httplib::Request&, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, X-User-Id");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, X-User-Id, Cache-Control, X-Timeout-Ms");
     });
 
+    // Keep top sections and trending keywords warm
+    NewsCache::shared().start();
+
     std::cout << "✅ Server running on port " << port << std::endl;
     std::cout << "🌐 CORS enabled for web browser access" << std::endl;
+    std::cout << "🧵 Workers: " << options.threadPoolSize << " | Max in-flight chats: "
+              << chatAdmission->getLimit() << std::endl;
     running = true;
     svr.listen("0.0.0.0", port);
 }
@@ -342,6 +876,20 @@ void APIServer::start() {
 
 
 void APIServer::stop() {
+    NewsCache::shared().stop();
+    NewsCache::shared().setStore(nullptr);
+    chatbot->stopResponseCorpus();
+    if (responseLoader.joinable()) responseLoader.join();
+    if (snapshotThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            snapshotStopping = true;
+        }
+        snapshotCv.notify_all();
+        snapshotThread.join();
+        writeSnapshot();
+    }
+    if (messageLog) messageLog->stop();
     running = false;
 }
 
@@ -3,10 +3,19 @@
 
 #include "Chatbot.h"
 #include "FirebaseClient.h"
+#include "AdmissionController.h"
+#include "NewsCache.h"
+#include "MessageLog.h"
+#include "Snapshot.h"
 #include <string>
 #include <memory>
 #include <functional>
 #include <map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
 
 // API Request structure
 struct APIRequest {
@@ -29,14 +38,65 @@ struct APIResponse {
     }
 };
 
+// HTTP server tuning (loaded from config.txt)
+struct ServerOptions {
+    int threadPoolSize;          // httplib worker threads
+    int maxQueuedConnections;    // accepted connections waiting for a worker (0 = unbounded)
+    int keepAliveMaxCount;       // requests served per keep-alive connection
+    int keepAliveTimeoutSec;     // idle keep-alive connections hold a worker this long
+    int readTimeoutSec;
+    int writeTimeoutSec;
+    int maxInflightChats;        // chats beyond this get a fast 503
+    int reservedWorkers;         // workers blocking requests may never occupy (health/metrics lane)
+    int responseCacheEntries;    // AI completion cache size (0 = disabled)
+    int responseCacheTtlSec;
+    SemanticCache::Options semanticCache;   // paraphrase cache (TTL shared with the response cache)
+    int contextTokenBudget;      // approximate tokens of history sent to the model
+    int contextCompactTokens;    // history size that triggers background summarization (0 = off)
+    int chatDeadlineMs;          // AI answers later than this fall back to the local one
+    bool hedgeRequests;          // re-send slow AI calls after the observed p95
+    MessageLog::Options wal;     // local message log (empty directory = disabled)
+    std::string snapshotPath;    // warm-start snapshot (empty = disabled)
+    int snapshotIntervalSec;
+    NewsCache::Options news;     // news TTLs and prefetch schedule
+    std::string responseCorpusPath;  // JSONL responses, reloaded on change (empty = none)
+
+    ServerOptions()
+        : threadPoolSize(16), maxQueuedConnections(256), keepAliveMaxCount(100),
+          keepAliveTimeoutSec(5), readTimeoutSec(5), writeTimeoutSec(5),
+          maxInflightChats(12), reservedWorkers(2),
+          responseCacheEntries(1024), responseCacheTtlSec(600), contextTokenBudget(4000), contextCompactTokens(3000),
+          chatDeadlineMs(8000), hedgeRequests(true),
+          snapshotPath("snapshot.bin"), snapshotIntervalSec(300) {}
+};
+
 // REST API Server
 class APIServer {
 private:
     std::unique_ptr<Chatbot> chatbot;
     std::unique_ptr<FirebaseClient> firebaseClient;
+    std::unique_ptr<AdmissionController> chatAdmission;
+    std::unique_ptr<AdmissionController> workerAdmission;   // every handler that blocks on upstream
+    std::unique_ptr<MessageLog> messageLog;  // durable store, replicated to Firebase
+    ServerOptions options;
     int port;
     bool running;
     
+    // Warm start: the mapped snapshot seeds AI sessions lazily
+    std::shared_ptr<SnapshotView> snapshotView;
+    std::mutex snapshotMutex;
+    std::unordered_set<std::string> clearedUsers;   // sessions in the snapshot are stale
+    std::thread snapshotThread;
+    std::condition_variable snapshotCv;
+    bool snapshotStopping;
+    std::atomic<double> snapshotLoadMs;         // read by /api/metrics
+    std::atomic<long long> snapshotsWritten;
+    
+    // Custom responses bulk-loaded from Firebase after startup
+    std::thread responseLoader;
+    std::atomic<bool> customResponsesReady;
+    double customResponseLoadMs;
+    
     // Route handlers
     APIResponse handleChat(const APIRequest& req);
     APIResponse handleHistory(const APIRequest& req);
@@ -44,16 +104,28 @@ private:
     APIResponse handleAddResponse(const APIRequest& req);
     APIResponse handleStatistics(const APIRequest& req);
     APIResponse handleHealth(const APIRequest& req);
+    APIResponse handleMetrics(const APIRequest& req);
+    
+    void markCleared(const std::string& userId);
+    APIResponse busyResponse() const;
+    void openMessageLog();
+    void loadSnapshot();
+    void writeSnapshot();
+    void snapshotLoop();
+    void loadCustomResponses();
+    void loadNewsIndex();
     
     // Helper functions
     std::string extractUserId(const APIRequest& req) const;
+    static bool isValidUserId(const std::string& userId);
     std::string parseJsonField(const std::string& json, const std::string& field) const;
     APIResponse jsonResponse(int code, const std::string& message, const std::string& data = "") const;
     APIResponse errorResponse(int code, const std::string& message) const;
     
 public:
     APIServer(int port, const std::string& firebaseUrl, const std::string& firebaseKey,
-              const std::string& groqKey = "", const std::string& groqModel = "");
+              const std::string& groqKey = "", const std::string& groqModel = "",
+              const ServerOptions& opts = ServerOptions());
     ~APIServer();
     
     // Server control
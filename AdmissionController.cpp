@@ -0,0 +1,36 @@
+#include "AdmissionController.h"
+
+AdmissionController::AdmissionController(int maxInflight)
+    : maxInflight(maxInflight > 0 ? maxInflight : 1), inflight(0), admitted(0), rejected(0) {}
+
+bool AdmissionController::tryAcquire() {
+    int current = inflight.load(std::memory_order_relaxed);
+    while (current < maxInflight) {
+        if (inflight.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+            admitted.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AdmissionController::release() {
+    inflight.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+int AdmissionController::getLimit() const {
+    return maxInflight;
+}
+
+int AdmissionController::getInflight() const {
+    return inflight.load(std::memory_order_relaxed);
+}
+
+long long AdmissionController::getAdmitted() const {
+    return admitted.load(std::memory_order_relaxed);
+}
+
+long long AdmissionController::getRejected() const {
+    return rejected.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <atomic>
+
+// Caps the number of in-flight requests of one kind (e.g. chats).
+// Requests over the limit are rejected immediately so the caller can
+// answer with a fast 503 instead of queueing behind slow AI calls.
+class AdmissionController {
+private:
+    int maxInflight;
+    std::atomic<int> inflight;
+    std::atomic<long long> admitted;
+    std::atomic<long long> rejected;
+
+public:
+    explicit AdmissionController(int maxInflight);
+
+    // Returns false if the request must be shed
+    bool tryAcquire();
+    void release();
+
+    int getLimit() const;
+    int getInflight() const;
+    long long getAdmitted() const;
+    long long getRejected() const;
+};
+
+// RAII guard: releases the slot when the request finishes
+class AdmissionTicket {
+private:
+    AdmissionController& controller;
+    bool granted;
+
+public:
+    explicit AdmissionTicket(AdmissionController& ctrl)
+        : controller(ctrl), granted(ctrl.tryAcquire()) {}
+    ~AdmissionTicket() {
+        if (granted) controller.release();
+    }
+
+    AdmissionTicket(const AdmissionTicket&) = delete;
+    AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+    bool isGranted() const { return granted; }
+};
+
+#endif // ADMISSIONCONTROLLER_H
@@ -0,0 +1,175 @@
+#include "AsyncHttp.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+// One in-flight transfer; owned by the event loop until completion
+struct AsyncHttp::Transfer {
+    CURL* easy;
+    curl_slist* headerList;
+    HttpRequest request;
+    std::string response;
+    Callback done;
+    std::chrono::steady_clock::time_point started;
+
+    Transfer(const HttpRequest& req, Callback cb)
+        : easy(nullptr), headerList(nullptr), request(req), done(std::move(cb)) {}
+};
+
+static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    ((std::string*)userp)->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+AsyncHttp::AsyncHttp() : stopping(false), inflight(0), completed(0) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi = curl_multi_init();
+    loop = std::thread(&AsyncHttp::run, this);
+}
+
+AsyncHttp::~AsyncHttp() {
+    stopping = true;
+    curl_multi_wakeup(multi);
+    if (loop.joinable()) {
+        loop.join();
+    }
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
+}
+
+AsyncHttp& AsyncHttp::shared() {
+    static AsyncHttp instance;
+    return instance;
+}
+
+void AsyncHttp::submit(const HttpRequest& req, Callback done) {
+    Transfer* t = new Transfer(req, std::move(done));
+    inflight++;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.push_back(t);
+    }
+    curl_multi_wakeup(multi);
+}
+
+std::future<HttpResult> AsyncHttp::submit(const HttpRequest& req) {
+    auto promise = std::make_shared<std::promise<HttpResult>>();
+    std::future<HttpResult> future = promise->get_future();
+    submit(req, [promise](HttpResult result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+HttpResult AsyncHttp::perform(const HttpRequest& req) {
+    return submit(req).get();
+}
+
+void AsyncHttp::startPending() {
+    std::deque<Transfer*> batch;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        batch.swap(pending);
+    }
+
+    for (Transfer* t : batch) {
+        t->easy = curl_easy_init();
+        if (!t->easy) {
+            HttpResult result;
+            result.curlCode = CURLE_FAILED_INIT;
+            t->done(std::move(result));
+            delete t;
+            inflight--;
+            continue;
+        }
+
+        for (const auto& h : t->request.headers) {
+            t->headerList = curl_slist_append(t->headerList, h.c_str());
+        }
+
+        const HttpRequest& req = t->request;
+        curl_easy_setopt(t->easy, CURLOPT_URL, req.url.c_str());
+        if (req.method == "POST") {
+            curl_easy_setopt(t->easy, CURLOPT_POSTFIELDS, req.body.c_str());
+        } else if (req.method != "GET") {
+            curl_easy_setopt(t->easy, CURLOPT_CUSTOMREQUEST, req.method.c_str());
+            if (!req.body.empty()) {
+                curl_easy_setopt(t->easy, CURLOPT_POSTFIELDS, req.body.c_str());
+            }
+        }
+        if (t->headerList) {
+            curl_easy_setopt(t->easy, CURLOPT_HTTPHEADER, t->headerList);
+        }
+        curl_easy_setopt(t->easy, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(t->easy, CURLOPT_WRITEDATA, &t->response);
+        curl_easy_setopt(t->easy, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(t->easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(t->easy, CURLOPT_PRIVATE, t);
+        if (req.timeoutMs > 0) {
+            curl_easy_setopt(t->easy, CURLOPT_TIMEOUT_MS, req.timeoutMs);
+        }
+
+        t->started = std::chrono::steady_clock::now();
+        active.insert(t);
+        curl_multi_add_handle(multi, t->easy);
+    }
+}
+
+void AsyncHttp::finish(CURL* easy, CURLcode code) {
+    Transfer* t = nullptr;
+    curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char**)&t);
+    curl_multi_remove_handle(multi, easy);
+    active.erase(t);
+
+    HttpResult result;
+    result.curlCode = code;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &result.statusCode);
+    result.body = std::move(t->response);
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t->started).count();
+
+    curl_slist_free_all(t->headerList);
+    curl_easy_cleanup(easy);
+
+    try {
+        t->done(std::move(result));
+    } catch (const std::exception& e) {
+        std::cerr << "[AsyncHttp] Callback error: " << e.what() << std::endl;
+    }
+    delete t;
+    inflight--;
+    completed++;
+}
+
+void AsyncHttp::run() {
+    int running = 0;
+    while (!stopping) {
+        startPending();
+
+        curl_multi_perform(multi, &running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finish(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        // Sleeps until socket activity, a timeout, or curl_multi_wakeup()
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+
+    // Fail whatever is still queued or running so no caller waits forever
+    startPending();
+    while (!active.empty()) {
+        finish((*active.begin())->easy, CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+int AsyncHttp::getInflight() const {
+    return inflight.load();
+}
+
+long long AsyncHttp::getCompleted() const {
+    return completed.load();
+}
@@ -0,0 +1,85 @@
+#ifndef ASYNCHTTP_H
+#define ASYNCHTTP_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <curl/curl.h>
+
+// Outbound HTTP request
+struct HttpRequest {
+    std::string method;                 // GET, POST, PUT, PATCH, DELETE
+    std::string url;
+    std::string body;
+    std::vector<std::string> headers;   // "Name: value"
+    long timeoutMs;
+
+    HttpRequest() : method("GET"), timeoutMs(30000) {}
+};
+
+// Result of a finished transfer
+struct HttpResult {
+    CURLcode curlCode;
+    long statusCode;
+    std::string body;
+    double elapsedMs;
+    bool rejected;                      // failed fast by a circuit breaker, never sent
+
+    HttpResult() : curlCode(CURLE_OK), statusCode(0), elapsedMs(0), rejected(false) {}
+
+    bool ok() const { return curlCode == CURLE_OK && !rejected; }
+    std::string error() const { return rejected ? "circuit open" : curl_easy_strerror(curlCode); }
+};
+
+// I/O executor for upstream calls (Groq, Firebase, Guardian).
+// A single thread drives every transfer through a curl_multi event loop,
+// so thousands of in-flight requests cost sockets, not threads, and the
+// connection cache is shared across callers.
+class AsyncHttp {
+public:
+    typedef std::function<void(HttpResult)> Callback;
+
+private:
+    struct Transfer;
+
+    CURLM* multi;
+    std::thread loop;
+    std::mutex mtx;
+    std::deque<Transfer*> pending;   // submitted, not yet added to the multi handle
+    std::unordered_set<Transfer*> active;  // owned by the loop thread
+    std::atomic<bool> stopping;
+    std::atomic<int> inflight;
+    std::atomic<long long> completed;
+
+    void run();
+    void startPending();
+    void finish(CURL* easy, CURLcode code);
+
+public:
+    AsyncHttp();
+    ~AsyncHttp();
+
+    AsyncHttp(const AsyncHttp&) = delete;
+    AsyncHttp& operator=(const AsyncHttp&) = delete;
+
+    // Process-wide executor
+    static AsyncHttp& shared();
+
+    // Callback runs on the event-loop thread and must not block
+    void submit(const HttpRequest& req, Callback done);
+    std::future<HttpResult> submit(const HttpRequest& req);
+
+    // Blocking convenience for callers that need the answer inline
+    HttpResult perform(const HttpRequest& req);
+
+    int getInflight() const;
+    long long getCompleted() const;
+};
+
+#endif // ASYNCHTTP_H
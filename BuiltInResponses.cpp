@@ -0,0 +1,218 @@
+#include "BuiltInResponses.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace {
+
+struct Entry {
+    const char* key;
+    const char* values[2];  // multiple responses for the same key
+};
+
+constexpr Entry kEntries[] = {
+    // Greetings
+    {"hello", {"Hello! How can I help you today?"}},
+    {"hi", {"Hi there! What's on your mind?"}},
+    {"hey", {"Hey! Nice to meet you!"}},
+    {"greetings", {"Greetings! How may I assist you?"}},
+
+    {"name", {"I'm a chatbot created using Data Structures and Algorithms!"}},
+    {"who", {"I'm an AI chatbot. What would you like to know?"}},
+    {"what", {"I'm here to help answer your questions!"}},
+
+    {"help", {"I'm here to help! What do you need assistance with?"}},
+    {"assist", {"Of course! How can I assist you?"}},
+    {"support", {"I'm here to support you. What's the issue?"}},
+
+    {"bye", {"Goodbye! Have a great day!"}},
+    {"goodbye", {"Farewell! Take care!"}},
+    {"exit", {"See you later! Thanks for chatting!"}},
+
+    {"thanks", {"You're welcome! Happy to help!"}},
+    {"thank", {"You're very welcome!"}},
+    {"appreciate", {"I'm glad I could help!"}},
+
+    {"how", {"I'm doing great! How about you?"}},
+    {"fine", {"That's wonderful to hear!"}},
+    {"good", {"That's great! What else can I help with?"}},
+
+    {"weather", {"I don't have access to weather data, but I hope it's nice where you are!"}},
+    {"time", {"I can't tell the exact time, but I'm here whenever you need me!"}},
+
+    // Phrases
+    {"how are you", {"I'm doing great, thanks for asking! How about you?"}},
+    {"what is your name", {"I'm a chatbot! You can call me ChatBot."}},
+    {"tell me about yourself", {"I'm a chatbot built using C++ and various data structures like Linked Lists, Queues, Stacks, and Hash Maps!"}},
+    {"what can you do", {"I can chat with you, remember our conversation, and help answer questions!"}},
+
+    {"joke", {"Why don't scientists trust atoms? Because they make up everything!",
+              "Why did the scarecrow win an award? He was outstanding in his field!"}},
+    {"funny", {"I try to be funny! Did you hear about the mathematician who's afraid of negative numbers? He'll stop at nothing to avoid them!"}},
+};
+
+constexpr int kCount = sizeof(kEntries) / sizeof(kEntries[0]);
+constexpr int kBuckets = (kCount + 3) / 4;  // about four keys share a displacement seed
+constexpr uint32_t kMaxSeed = 1u << 20;
+
+constexpr size_t length(const char* s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+// FNV-1a over a seeded basis, finished with murmur3's avalanche so that the
+// low bits used by % are well mixed
+constexpr uint32_t hashKey(const char* s, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+struct PerfectHash {
+    uint32_t seed[kBuckets];  // per bucket: the seed placing its keys in free slots
+    int entry[kCount];        // slot -> index into kEntries
+};
+
+// Hash-and-displace: keys fall into buckets by hashKey(key, 0); buckets are
+// placed largest first, each trying seeds until all of its keys land in
+// distinct empty slots. A duplicate key never fits and fails the build.
+constexpr PerfectHash buildPerfectHash() {
+    PerfectHash ph{};
+    int bucketOf[kCount] = {};
+    int bucketSize[kBuckets] = {};
+    for (int i = 0; i < kCount; i++) {
+        bucketOf[i] = (int)(hashKey(kEntries[i].key, length(kEntries[i].key), 0) % kBuckets);
+        bucketSize[bucketOf[i]]++;
+    }
+
+    int order[kBuckets] = {};
+    for (int b = 0; b < kBuckets; b++) order[b] = b;
+    for (int a = 0; a < kBuckets; a++) {
+        for (int b = a + 1; b < kBuckets; b++) {
+            if (bucketSize[order[b]] > bucketSize[order[a]]) {
+                int t = order[a];
+                order[a] = order[b];
+                order[b] = t;
+            }
+        }
+    }
+
+    bool used[kCount] = {};
+    for (int o = 0; o < kBuckets; o++) {
+        int b = order[o];
+        if (bucketSize[b] == 0) continue;
+        uint32_t seed = 1;
+        for (; seed < kMaxSeed; seed++) {
+            int slots[kCount] = {};
+            int placed = 0;
+            bool fits = true;
+            for (int i = 0; i < kCount && fits; i++) {
+                if (bucketOf[i] != b) continue;
+                int s = (int)(hashKey(kEntries[i].key, length(kEntries[i].key), seed) % kCount);
+                fits = !used[s];
+                for (int p = 0; p < placed && fits; p++) fits = slots[p] != s;
+                slots[placed++] = s;
+            }
+            if (!fits) continue;
+            placed = 0;
+            for (int i = 0; i < kCount; i++) {
+                if (bucketOf[i] != b) continue;
+                used[slots[placed]] = true;
+                ph.entry[slots[placed++]] = i;
+            }
+            ph.seed[b] = seed;
+            break;
+        }
+        if (seed == kMaxSeed) throw "no perfect hash: duplicate built-in key?";
+    }
+    return ph;
+}
+
+constexpr PerfectHash kHash = buildPerfectHash();
+
+constexpr int slotOf(const char* s, size_t len) {
+    return (int)(hashKey(s, len, kHash.seed[hashKey(s, len, 0) % kBuckets]) % kCount);
+}
+
+constexpr bool sameKey(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+constexpr bool everyKeyFindsItself() {
+    for (int i = 0; i < kCount; i++) {
+        if (!sameKey(kEntries[kHash.entry[slotOf(kEntries[i].key, length(kEntries[i].key))]].key, kEntries[i].key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(everyKeyFindsItself(), "built-in response hash is not perfect");
+
+const Entry* find(const std::string& key) {
+    const Entry& entry = kEntries[kHash.entry[slotOf(key.data(), key.size())]];
+    return key.compare(entry.key) == 0 ? &entry : nullptr;
+}
+
+} // namespace
+
+std::vector<std::string> BuiltInResponses::get(const std::string& key) {
+    std::vector<std::string> values;
+    if (const Entry* entry = find(key)) {
+        for (const char* value : entry->values) {
+            if (value) values.push_back(value);
+        }
+    }
+    return values;
+}
+
+bool BuiltInResponses::contains(const std::string& key) {
+    return find(key) != nullptr;
+}
+
+std::vector<std::string> BuiltInResponses::getAllKeys() {
+    std::vector<std::string> keys;
+    keys.reserve(kCount);
+    for (const Entry& entry : kEntries) {
+        keys.push_back(entry.key);
+    }
+    return keys;
+}
+
+int BuiltInResponses::getSize() {
+    return kCount;
+}
+
+const SymSpellIndex& BuiltInResponses::fuzzyIndex() {
+    static const SymSpellIndex index = []() {
+        SymSpellIndex built;
+        for (const Entry& entry : kEntries) {
+            built.add(entry.key);
+        }
+        return built;
+    }();
+    return index;
+}
+
+const ResponseIndex& BuiltInResponses::rankedIndex() {
+    static const ResponseIndex index = []() {
+        ResponseIndex built;
+        for (const Entry& entry : kEntries) {
+            built.add(entry.key);
+        }
+        return built;
+    }();
+    return index;
+}
@@ -0,0 +1,25 @@
+#ifndef BUILTINRESPONSES_H
+#define BUILTINRESPONSES_H
+
+#include "SymSpellIndex.h"
+#include "ResponseIndex.h"
+#include <string>
+#include <vector>
+
+// The responses every user starts with. The table and its minimal perfect
+// hash are both computed by the compiler, so building a Chatbot allocates
+// and inserts nothing; per-user additions live in UserResponses.
+class BuiltInResponses {
+public:
+    // Same shape as ResponseMap so one matcher serves both
+    static std::vector<std::string> get(const std::string& key);
+    static bool contains(const std::string& key);
+    static std::vector<std::string> getAllKeys();
+    static int getSize();
+    // Typo index over the keys, built once per process on first use
+    static const SymSpellIndex& fuzzyIndex();
+    // BM25 index over the keys, likewise
+    static const ResponseIndex& rankedIndex();
+};
+
+#endif // BUILTINRESPONSES_H
@@ -3,9 +3,13 @@
 #include "Queue.h"
 #include "Stack.h"
 #include "GuardianAPI.h"
+#include "NewsCache.h"
+#include "NewsIndex.h"
 #include "HashMap.h"
+#include "BuiltInResponses.h"
+#include "Tokenizer.h"
+#include <functional>
 #include <ctime>
-#include <sstream>
 #include <algorithm>
 #include <random>
 #include <iostream>
@@ -37,25 +41,19 @@ void Chatbot::searchConversation(const std::string& keyword) const {
 
 
 // Chatbot Implementation
-Chatbot::Chatbot() : messageCount(0), useAI(false) {
-    conversationHistory = std::make_unique<ConversationHistory>();
+Chatbot::Chatbot() : messageCount(0), useAI(false), fuzzyMatches(0) {
+    conversationHistory = std::make_unique<ConversationHistory>(1000);
     messageQueue = std::make_unique<MessageQueue>(100);
     undoStack = std::make_unique<MessageStack>(50);
-    responseMap = std::make_unique<ResponseMap>();
+    registerIntents();
     
-    // Groq client will be initialized via initializeAI()
-    loadResponses(); // Ensure responses are loaded
+    // Groq client will be initialized via initializeAI(); built-in
+    // responses are a compile-time table (BuiltInResponses)
 }
 
 
 Chatbot::~Chatbot() = default;
 
-std::string Chatbot::toLowerCase(const std::string& str) {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
-}
-
 std::string Chatbot::getCurrentTime() const {
     time_t now = time(0);
     char* dt = ctime(&now);
@@ -65,95 +63,191 @@ std::string Chatbot::getCurrentTime() const {
 }
 
 void Chatbot::addToHistory(const Message& msg) {
+    std::lock_guard<std::mutex> lock(historyMutex);
     conversationHistory->insertAtEnd(msg);
     messageQueue->enqueue(msg);
     messageCount++;
 }
 
-std::string Chatbot::findBestResponse(const std::string& input) {
-    std::string lowerInput = toLowerCase(input);
+enum MatchTier { EXACT_MATCH, RANKED_MATCH, FUZZY_MATCH };
+
+// Edits tolerated in a word of this length ("helo", "thnks"); very short
+// words would match almost anything
+static int typoBudget(size_t length) {
+    return length < 3 ? 0 : (length <= 5 ? 1 : 2);
+}
 
+// One tier of matching against one map: the exact phrase, the key that
+// scores best against all the input's terms, or the phrase or a word within
+// a few typos of a key
+template <typename Map>
+static std::vector<std::string> matchResponses(const Map& responseMap, const SymSpellIndex& fuzzy,
+                                               const ResponseIndex& ranked, MatchTier tier, const Tokenizer& input) {
+    const std::vector<TokenView>& words = input.tokens();
+    if (tier == EXACT_MATCH) {
+        // As typed, then without its punctuation ("what is your name?")
+        std::vector<std::string> responses = responseMap.get(input.folded());
+        if (responses.empty() && input.phrase() != input.folded()) {
+            responses = responseMap.get(input.phrase());
+        }
+        if (!responses.empty()) {
+            std::cerr << "[DEBUG] Exact match for input: '" << input.folded() << "'\n";
+        }
+        return responses;
+    }
     
-    // ========== NEWS QUERIES ==========
-    if (lowerInput.find("news") != std::string::npos || 
-        lowerInput.find("latest") != std::string::npos ||
-        lowerInput.find("headlines") != std::string::npos) {
-        
-        std::istringstream iss(lowerInput);
-        std::string word;
-        std::string keyword = "general";  // default if no keyword found
-
-        while (iss >> word) {
-            if (word != "news" &&
-                word != "latest" &&
-                word != "headlines" &&
-                word != "about" &&
-                word != "on" &&
-                word != "the") {
-                keyword = word;   // first meaningful word
-                break;
-            }
+    if (tier == RANKED_MATCH) {
+        std::string key;
+        double score = 0;
+        if (ranked.best(words, key, score)) {
+            std::cerr << "[DEBUG] Ranked match key: '" << key << "' (score " << score << ")\n";
+            return responseMap.get(key);
         }
+        return {};
+    }
+    
+    std::string key;
+    int distance = 0;
+    const std::string& phrase = input.phrase();
+    if (words.size() > 1 && fuzzy.lookup(phrase, typoBudget(phrase.size()), key, distance)) {
+        std::cerr << "[DEBUG] Fuzzy match key: '" << key << "' (" << distance << " edits)\n";
+        return responseMap.get(key);
+    }
+    static thread_local std::string word;  // reused, like the tokenizer's buffers
+    for (const TokenView& w : words) {
+        word.assign(w.data, w.size);
+        if (fuzzy.lookup(word, typoBudget(word.size()), key, distance)) {
+            std::cerr << "[DEBUG] Fuzzy match key: '" << key << "' for word: '" << word << "' (" << distance << " edits)\n";
+            return responseMap.get(key);
+        }
+    }
+    return {};
+}
+
+// Within a tier the user's own keywords win over the shared corpus and
+// the corpus over the built-ins, but a closer built-in match beats a
+// looser custom one
+std::vector<std::string> Chatbot::matchTier(int tier, const Tokenizer& tokens, const std::string& userId,
+                                           bool builtIns) const {
+    auto matcher = [&](const ResponseMap& responses, const SymSpellIndex& fuzzy, const ResponseIndex& ranked) {
+        return matchResponses(responses, fuzzy, ranked, (MatchTier)tier, tokens);
+    };
+    std::vector<std::string> responses = userResponses.match(userId, matcher);
+    if (responses.empty()) {
+        responses = corpus.match(matcher);
+    }
+    if (responses.empty() && builtIns) {
+        responses = matchResponses(BuiltInResponses(), BuiltInResponses::fuzzyIndex(),
+                                   BuiltInResponses::rankedIndex(), (MatchTier)tier, tokens);
+    }
+    return responses;
+}
 
-        std::cout << "[Fetching news from Guardian API...]" << std::endl;
+static std::string pickResponse(const std::vector<std::string>& responses) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, responses.size() - 1);
+    return responses[dis(gen)];
+}
 
-        std::string jsonResponse = GuardianAPI::fetchNews(keyword, 5);
-        auto articles = GuardianAPI::parseNews(jsonResponse);
-        std::string newsResponse = GuardianAPI::formatNewsResponse(articles);
+// ========== INTENTS ==========
 
-        return newsResponse;
-    }
+// Highest priority first: news questions go to the news sources, a keyword
+// the user (or the shared corpus) defined exactly is answered locally, then
+// the AI, and the built-ins and ranked and typo-tolerant matchers have the
+// last word. Built-in greetings stay behind the AI, as before routing.
+void Chatbot::registerIntents() {
+    using namespace std::placeholders;
+    router.addIntent("news", 30, {"news", "latest", "headlines"}, {"top stories"},
+                     std::bind(&Chatbot::answerNews, this, _1, _2));
+    router.addIntent("exact", 20, {}, {}, std::bind(&Chatbot::answerExact, this, _1, _2));
+    router.addIntent("ai", 10, {}, {}, std::bind(&Chatbot::answerAI, this, _1, _2));
+    router.addIntent("local", 0, {}, {}, std::bind(&Chatbot::answerLocal, this, _1, _2));
+    router.compile();
+}
 
-    // ========== CHECK HASHMAP FIRST (Fast responses) ==========
-    
-    // Exact phrase match
-    std::vector<std::string> responses = responseMap->get(lowerInput);
-    if (!responses.empty()) {
-        std::cerr << "[DEBUG] Exact match for input: '" << lowerInput << "'\n";
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, responses.size() - 1);
-        return responses[dis(gen)];
-    }
-    
-    // Individual word matching
-    std::istringstream iss(lowerInput);
-    std::vector<std::string> words;
-    std::string word;
-    
-    while (iss >> word) {
-        words.push_back(word);
+bool Chatbot::answerNews(const IntentRouter::Request& request, std::string& response) {
+    std::string keyword = "general";  // default if no keyword found
+
+    for (const TokenView& word : request.tokens.tokens()) {
+        if (!(word == "news" ||
+              word == "latest" ||
+              word == "headlines" ||
+              word == "top" ||
+              word == "stories" ||
+              word == "about" ||
+              word == "on" ||
+              word == "the")) {
+            keyword = word.str();   // first meaningful word
+            break;
+        }
     }
-    
-    for (const auto& w : words) {
-        std::vector<std::string> wordResponses = responseMap->get(w);
-        if (!wordResponses.empty()) {
-            std::cerr << "[DEBUG] Word match for word: '" << w << "'\n";
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(0, wordResponses.size() - 1);
-            return wordResponses[dis(gen)];
+
+    // Served from the TTL news cache; only misses reach the Guardian API
+    auto articles = NewsCache::shared().get(keyword);
+    if (articles.empty()) {
+        // Nothing cached and the Guardian is unreachable: search the local index
+        for (const auto& hit : NewsIndex::shared().search(keyword, 5)) {
+            GuardianAPI::NewsArticle article;
+            article.title = hit.title;
+            article.url = hit.url;
+            article.section = hit.section;
+            article.date = hit.date;
+            articles.push_back(article);
         }
     }
+    response = GuardianAPI::formatNewsResponse(articles);
+    return true;
+}
+
+bool Chatbot::answerExact(const IntentRouter::Request& request, std::string& response) {
+    std::vector<std::string> responses = matchTier(EXACT_MATCH, request.tokens, request.userId, false);
+    if (responses.empty()) return false;
+    response = pickResponse(responses);
+    return true;
+}
+
+bool Chatbot::answerAI(const IntentRouter::Request& request, std::string& response) {
+    if (!request.allowAI || !isAIEnabled()) return false;
+    std::cerr << "[Chatbot] Using Groq AI for response..." << std::endl;
+    response = groqClient->sendMessage(request.userId, request.text, request.allowCache, request.deadline);
     
-    // Partial word matching
-    for (const auto& w : words) {
-        std::vector<std::string> allKeys = responseMap->getAllKeys();
-        for (const auto& key : allKeys) {
-            if (key.find(w) != std::string::npos || w.find(key) != std::string::npos) {
-                std::vector<std::string> partialResponses = responseMap->get(key);
-                if (!partialResponses.empty()) {
-                    std::cerr << "[DEBUG] Partial match key: '" << key << "' for word: '" << w << "'\n";
-                    std::random_device rd;
-                    std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> dis(0, partialResponses.size() - 1);
-                    return partialResponses[dis(gen)];
-                }
-            }
+    if (response.empty()) {
+        std::cerr << "[Chatbot] AI response empty, falling back to local" << std::endl;
+        return false;
+    }
+    std::cerr << "[Chatbot] AI response received successfully" << std::endl;
+    return true;
+}
+
+// Custom exact keywords already ran as their own intent; the built-in
+// exact tier runs here, after the AI
+bool Chatbot::answerLocal(const IntentRouter::Request& request, std::string& response) {
+    std::cerr << "[Chatbot] Using local response matching" << std::endl;
+    for (MatchTier tier : {EXACT_MATCH, RANKED_MATCH, FUZZY_MATCH}) {
+        std::vector<std::string> responses = matchTier(tier, request.tokens, request.userId);
+        if (!responses.empty()) {
+            if (tier == FUZZY_MATCH) fuzzyMatches++;
+            response = pickResponse(responses);
+            return true;
         }
     }
+    response = "I'm not sure how to respond to that. Could you try rephrasing?";
+    return true;
+}
+
+std::string Chatbot::findBestResponse(const std::string& input, const std::string& userId, bool allowAI,
+                                      bool allowCache, GroqClient::Clock::time_point deadline) {
+    // Normalized and split once per request; the router and every matcher
+    // read the same views, and the buffers are reused by this thread's next
+    // request
+    static thread_local Tokenizer tokens;
+    tokens.tokenize(input);
     
-    return "I'm not sure how to respond to that. Could you try rephrasing?";
+    IntentRouter::Request request = {input, tokens, userId, allowAI, allowCache, deadline};
+    std::string response;
+    router.dispatch(request, response);
+    return response;
 }
 
 std::string Chatbot::processUserInput(const std::string& input) {
@@ -166,19 +260,23 @@ std::string Chatbot::processUserInput(const std::string& input) {
     addToHistory(userMsg);
     
     // Find and generate response
-    std::string response = findBestResponse(input);
+    std::string response = findBestResponse(input, "local", false, true, GroqClient::Clock::time_point::max());
     
     // Add bot response to history
     Message botMsg(response, "bot", getCurrentTime());
     addToHistory(botMsg);
     
     // Push to undo stack
-    undoStack->push(userMsg);
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        undoStack->push(userMsg);
+    }
     
     return response;
 }
 
-std::string Chatbot::respond(const std::string& userInput) {
+std::string Chatbot::respond(const std::string& userInput, const std::string& userId, bool allowCache,
+                             GroqClient::Clock::time_point deadline) {
     if (userInput.empty()) {
         return "Please enter a message.";
     }
@@ -187,32 +285,18 @@ std::string Chatbot::respond(const std::string& userInput) {
     Message userMsg(userInput, "user", getCurrentTime());
     addToHistory(userMsg);
     
-    std::string response;
-    
-    // Try AI response if enabled
-    if (isAIEnabled()) {
-        std::cerr << "[Chatbot] Using Groq AI for response..." << std::endl;
-        response = groqClient->sendMessage(userInput);
-        
-        if (!response.empty()) {
-            std::cerr << "[Chatbot] AI response received successfully" << std::endl;
-        } else {
-            std::cerr << "[Chatbot] AI response empty, falling back to local" << std::endl;
-        }
-    }
-    
-    // Fallback to local response if AI fails or is disabled
-    if (response.empty()) {
-        std::cerr << "[Chatbot] Using local response matching" << std::endl;
-        response = findBestResponse(userInput);
-    }
+    // News, an exact keyword, the AI if enabled, then local matching
+    std::string response = findBestResponse(userInput, userId, true, allowCache, deadline);
     
     // Add bot response to history
     Message botMsg(response, "bot", getCurrentTime());
     addToHistory(botMsg);
     
     // Push to undo stack
-    undoStack->push(userMsg);
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        undoStack->push(userMsg);
+    }
     
     return response;
 }
@@ -229,6 +313,91 @@ void Chatbot::initializeAI(const std::string& apiKey, const std::string& model)
     }
 }
 
+void Chatbot::configureResponseCache(size_t maxEntries, int ttlSeconds) {
+    if (groqClient) {
+        groqClient->configureCache(maxEntries, ttlSeconds);
+    }
+}
+
+void Chatbot::configureSemanticCache(const SemanticCache::Options& options) {
+    if (groqClient) {
+        groqClient->configureSemanticCache(options);
+    }
+}
+
+void Chatbot::configureContextWindow(size_t tokenBudget, size_t compactAfterTokens) {
+    if (groqClient) {
+        groqClient->setContextTokenBudget(tokenBudget);
+        groqClient->setCompactionThreshold(compactAfterTokens);
+    }
+}
+
+void Chatbot::setHedging(bool enabled) {
+    if (groqClient) {
+        groqClient->setHedging(enabled);
+    }
+}
+
+GroqClient::HedgeStats Chatbot::getHedgeStats() const {
+    return groqClient ? groqClient->getHedgeStats() : GroqClient::HedgeStats();
+}
+
+size_t Chatbot::getAISessionCount() const {
+    return groqClient ? groqClient->getSessionCount() : 0;
+}
+
+void Chatbot::restoreMessage(const std::string& userId, const Message& msg) {
+    addToHistory(msg);
+    if (groqClient) {
+        groqClient->restoreTurn(userId, msg.sender == "user" ? "user" : "assistant", msg.content);
+    }
+}
+
+std::vector<Message> Chatbot::getHistoryMessages() {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return conversationHistory->getAllMessages();
+}
+
+void Chatbot::restoreHistory(const std::vector<Message>& messages) {
+    for (const auto& msg : messages) {
+        addToHistory(msg);
+    }
+}
+
+std::vector<UserResponse> Chatbot::getResponses() const {
+    return userResponses.exportAll();
+}
+
+void Chatbot::restoreResponses(const std::vector<UserResponse>& responses) {
+    userResponses.merge(responses, 1);
+}
+
+void Chatbot::setSessionSeed(GroqClient::SessionSeed seed) {
+    if (groqClient) {
+        groqClient->setSessionSeed(seed);
+    }
+}
+
+void Chatbot::exportSessions(const GroqClient::SessionVisitor& visit) {
+    if (groqClient) {
+        groqClient->exportSessions(visit);
+    }
+}
+
+void Chatbot::clearUserContext(const std::string& userId) {
+    if (groqClient) {
+        groqClient->clearHistory(userId);
+    }
+}
+
+ResponseCache::Stats Chatbot::getResponseCacheStats() const {
+    return groqClient ? groqClient->getCacheStats() : ResponseCache::Stats();
+}
+
+SemanticCache::Stats Chatbot::getSemanticCacheStats() const {
+    return groqClient ? groqClient->getSemanticCacheStats() : SemanticCache::Stats();
+}
+
 void Chatbot::displayHistory() const {
     conversationHistory->displayAll();
 }
@@ -253,50 +422,48 @@ int Chatbot::getMessageCount() const {
     return messageCount;
 }
 
-void Chatbot::loadResponses() {
-    // Load responses into HashMap
-    responseMap->insert("hello", "Hello! How can I help you today?");
-    responseMap->insert("hi", "Hi there! What's on your mind?");
-    responseMap->insert("hey", "Hey! Nice to meet you!");
-    responseMap->insert("greetings", "Greetings! How may I assist you?");
-    
-    responseMap->insert("name", "I'm a chatbot created using Data Structures and Algorithms!");
-    responseMap->insert("who", "I'm an AI chatbot. What would you like to know?");
-    responseMap->insert("what", "I'm here to help answer your questions!");
-    
-    responseMap->insert("help", "I'm here to help! What do you need assistance with?");
-    responseMap->insert("assist", "Of course! How can I assist you?");
-    responseMap->insert("support", "I'm here to support you. What's the issue?");
-    
-    responseMap->insert("bye", "Goodbye! Have a great day!");
-    responseMap->insert("goodbye", "Farewell! Take care!");
-    responseMap->insert("exit", "See you later! Thanks for chatting!");
-    
-    responseMap->insert("thanks", "You're welcome! Happy to help!");
-    responseMap->insert("thank", "You're very welcome!");
-    responseMap->insert("appreciate", "I'm glad I could help!");
-    
-    responseMap->insert("how", "I'm doing great! How about you?");
-    responseMap->insert("fine", "That's wonderful to hear!");
-    responseMap->insert("good", "That's great! What else can I help with?");
-    
-    responseMap->insert("weather", "I don't have access to weather data, but I hope it's nice where you are!");
-    responseMap->insert("time", "I can't tell the exact time, but I'm here whenever you need me!");
-    
-    // Load responses into HashMap for phrase matching
-    responseMap->insert("how are you", "I'm doing great, thanks for asking! How about you?");
-    responseMap->insert("what is your name", "I'm a chatbot! You can call me ChatBot.");
-    responseMap->insert("tell me about yourself", "I'm a chatbot built using C++ and various data structures like Linked Lists, Queues, Stacks, and Hash Maps!");
-    responseMap->insert("what can you do", "I can chat with you, remember our conversation, and help answer questions!");
-    
-    // Add multiple responses for same keyword
-    responseMap->insert("joke", "Why don't scientists trust atoms? Because they make up everything!");
-    responseMap->insert("joke", "Why did the scarecrow win an award? He was outstanding in his field!");
-    responseMap->insert("funny", "I try to be funny! Did you hear about the mathematician who's afraid of negative numbers? He'll stop at nothing to avoid them!");
+void Chatbot::addCustomResponse(const std::string& keyword, const std::string& response,
+                                const std::string& userId) {
+    userResponses.add(userId, keyword, response);
+    std::cout << "Added custom response for keyword: " << keyword << "\n";
 }
 
-void Chatbot::addCustomResponse(const std::string& keyword, const std::string& response) {
-    responseMap->insert(keyword, response);
-    std::cout << "Added custom response for keyword: " << keyword << "\n";
+void Chatbot::mergeUserResponses(const std::vector<UserResponse>& responses, int threads) {
+    userResponses.merge(responses, threads);
 }
 
+IntentRouter::Stats Chatbot::getIntentStats() const {
+    return router.getStats();
+}
+
+void Chatbot::watchResponseCorpus(const std::string& path) {
+    corpus.start(path);
+}
+
+void Chatbot::stopResponseCorpus() {
+    corpus.stop();
+}
+
+ResponseCorpus::Stats Chatbot::getCorpusStats() const {
+    return corpus.getStats();
+}
+
+size_t Chatbot::getBuiltInResponseCount() const {
+    return BuiltInResponses::getSize();
+}
+
+size_t Chatbot::getCustomResponseCount() const {
+    return userResponses.getKeyCount();
+}
+
+size_t Chatbot::getCustomResponseUsers() const {
+    return userResponses.getUserCount();
+}
+
+UserResponses::Stats Chatbot::getCustomResponseStats() const {
+    return userResponses.getStats();
+}
+
+long long Chatbot::getFuzzyMatchCount() const {
+    return fuzzyMatches.load();
+}
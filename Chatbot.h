@@ -2,9 +2,14 @@
 #define CHATBOT_H
 #include "Message.h"
 #include "GroqClient.h"
+#include "UserResponses.h"
+#include "IntentRouter.h"
+#include "ResponseCorpus.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 // Forward declarations
 class MessageNode;
@@ -18,18 +23,29 @@ class ResponseMap;
 class Chatbot {
 private:
     std::unique_ptr<GroqClient> groqClient;  // AI client
+    std::mutex historyMutex;  // in-memory history is shared; held only around list updates
     std::unique_ptr<ConversationHistory> conversationHistory;  // Linked List
     std::unique_ptr<MessageQueue> messageQueue;        // Queue for processing
     std::unique_ptr<MessageStack> undoStack;           // Stack for undo
-    std::unique_ptr<ResponseMap> responseMap;          // Hash Map for responses
+    UserResponses userResponses;                       // per-user custom responses, checked before the built-ins
+    ResponseCorpus corpus;                             // shared responses from a watched file, between the two
     
     int messageCount;
     bool useAI;  // Flag to toggle AI vs local responses
+    std::atomic<long long> fuzzyMatches;  // answers found only by typo-tolerant lookup
+    IntentRouter router;                  // picks news, exact, AI or local for each message
     
     // Helper functions
-    std::string toLowerCase(const std::string& str);
     std::string processUserInput(const std::string& input);
-    std::string findBestResponse(const std::string& input);
+    std::string findBestResponse(const std::string& input, const std::string& userId, bool allowAI,
+                                 bool allowCache, GroqClient::Clock::time_point deadline);
+    std::vector<std::string> matchTier(int tier, const Tokenizer& tokens, const std::string& userId,
+                                       bool builtIns = true) const;
+    void registerIntents();
+    bool answerNews(const IntentRouter::Request& request, std::string& response);
+    bool answerExact(const IntentRouter::Request& request, std::string& response);
+    bool answerAI(const IntentRouter::Request& request, std::string& response);
+    bool answerLocal(const IntentRouter::Request& request, std::string& response);
     void addToHistory(const Message& msg);
  
 public:
@@ -37,15 +53,40 @@ public:
     ~Chatbot();
     
     // Main interface
-    std::string respond(const std::string& userInput);
+    // The AI answer is abandoned at the deadline in favour of the local one
+    std::string respond(const std::string& userInput, const std::string& userId = "local", bool allowCache = true,
+                        GroqClient::Clock::time_point deadline = GroqClient::Clock::time_point::max());
     void displayHistory() const;
     void clearHistory();
+    void clearUserContext(const std::string& userId);
+    // Rebuild in-memory state from a persisted message (startup replay)
+    void restoreMessage(const std::string& userId, const Message& msg);
+    
+    // Snapshot support
+    std::vector<Message> getHistoryMessages();
+    void restoreHistory(const std::vector<Message>& messages);
+    std::vector<UserResponse> getResponses() const;
+    void restoreResponses(const std::vector<UserResponse>& responses);
+    void setSessionSeed(GroqClient::SessionSeed seed);
+    void exportSessions(const GroqClient::SessionVisitor& visit);
     void undoLastMessage();
     int getMessageCount() const;
     
     // Utility functions
-    void loadResponses();
-    void addCustomResponse(const std::string& keyword, const std::string& response);
+    // Only this user's answers change; everyone else keeps the built-ins
+    void addCustomResponse(const std::string& keyword, const std::string& response,
+                           const std::string& userId = "local");
+    void mergeUserResponses(const std::vector<UserResponse>& responses, int threads);
+    size_t getBuiltInResponseCount() const;
+    size_t getCustomResponseCount() const;
+    size_t getCustomResponseUsers() const;
+    UserResponses::Stats getCustomResponseStats() const;
+    long long getFuzzyMatchCount() const;
+    IntentRouter::Stats getIntentStats() const;
+    // Serve the JSONL response file at path, reloading it whenever it changes
+    void watchResponseCorpus(const std::string& path);
+    void stopResponseCorpus();
+    ResponseCorpus::Stats getCorpusStats() const;
     std::string getCurrentTime() const;  // Make public for API use
     void displayRecent(int count) const;
     void searchConversation(const std::string& keyword) const;
@@ -54,6 +95,14 @@ public:
     void initializeAI(const std::string& apiKey, const std::string& model = "llama-3.3-70b-versatile");
     void setUseAI(bool enable) { useAI = enable; }
     bool isAIEnabled() const { return useAI && groqClient && groqClient->isAvailable(); }
+    void configureResponseCache(size_t maxEntries, int ttlSeconds);
+    ResponseCache::Stats getResponseCacheStats() const;
+    void configureSemanticCache(const SemanticCache::Options& options);
+    SemanticCache::Stats getSemanticCacheStats() const;
+    void configureContextWindow(size_t tokenBudget, size_t compactAfterTokens);
+    size_t getAISessionCount() const;
+    void setHedging(bool enabled);
+    GroqClient::HedgeStats getHedgeStats() const;
 
 
 };
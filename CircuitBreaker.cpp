@@ -0,0 +1,168 @@
+#include "CircuitBreaker.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <iostream>
+
+CircuitBreaker::CircuitBreaker(const std::string& name, const Options& opts)
+    : name(name), options(opts), outcomes(opts.window > 0 ? opts.window : 1, 0), next(0), count(0),
+      failedInWindow(0), slowInWindow(0), state(CLOSED), probeInFlight(false) {}
+
+bool CircuitBreaker::allow() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (state == CLOSED) {
+        return true;
+    }
+    if (state == OPEN && Clock::now() - openedAt >= std::chrono::milliseconds(options.openMs)) {
+        state = HALF_OPEN;
+        probeInFlight = false;
+    }
+    if (state == HALF_OPEN && !probeInFlight) {
+        probeInFlight = true;
+        std::cerr << "[Breaker] " << name << " half-open, sending probe" << std::endl;
+        return true;
+    }
+    stats.rejected++;
+    return false;
+}
+
+void CircuitBreaker::onSuccess(double latencyMs) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (state == HALF_OPEN) {
+        std::cerr << "[Breaker] " << name << " probe succeeded, closing" << std::endl;
+        state = CLOSED;
+        probeInFlight = false;
+        resetWindow();
+    }
+    record(false, latencyMs);
+}
+
+void CircuitBreaker::onFailure(double latencyMs) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (state == HALF_OPEN) {
+        std::cerr << "[Breaker] " << name << " probe failed, re-opening" << std::endl;
+        open();
+        return;
+    }
+    record(true, latencyMs);
+}
+
+void CircuitBreaker::onResult(const HttpResult& result, double latencyMs) {
+    if (!result.ok() || result.statusCode >= 500 || result.statusCode == 429) {
+        onFailure(latencyMs);
+    } else {
+        onSuccess(latencyMs);
+    }
+}
+
+void CircuitBreaker::record(bool failed, double latencyMs) {
+    bool slow = latencyMs >= options.slowCallMs;
+    stats.calls++;
+    if (failed) stats.failures++;
+
+    // Replace the oldest outcome once the window is full
+    if (count == outcomes.size()) {
+        unsigned char old = outcomes[next];
+        if (old & 1) failedInWindow--;
+        if (old & 2) slowInWindow--;
+    } else {
+        count++;
+    }
+    outcomes[next] = (unsigned char)((failed ? 1 : 0) | (slow ? 2 : 0));
+    if (failed) failedInWindow++;
+    if (slow) slowInWindow++;
+    next = (next + 1) % outcomes.size();
+
+    if (state == CLOSED && count >= options.minCalls &&
+        ((double)failedInWindow / count >= options.failureRate ||
+         (double)slowInWindow / count >= options.slowCallRate)) {
+        std::cerr << "[Breaker] " << name << " opened after " << failedInWindow << " failures and "
+                  << slowInWindow << " slow calls in the last " << count << std::endl;
+        open();
+    }
+}
+
+void CircuitBreaker::open() {
+    state = OPEN;
+    openedAt = Clock::now();
+    probeInFlight = false;
+    stats.trips++;
+    resetWindow();
+}
+
+void CircuitBreaker::resetWindow() {
+    std::fill(outcomes.begin(), outcomes.end(), 0);
+    next = 0;
+    count = 0;
+    failedInWindow = 0;
+    slowInWindow = 0;
+}
+
+CircuitBreaker::Stats CircuitBreaker::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats result = stats;
+    result.state = state;
+    result.failureRate = count > 0 ? (double)failedInWindow / count : 0.0;
+    return result;
+}
+
+// Breakers are never destroyed, so references handed out stay valid
+static std::mutex registryMutex;
+static std::map<std::string, std::unique_ptr<CircuitBreaker>>& registry() {
+    static std::map<std::string, std::unique_ptr<CircuitBreaker>> breakers;
+    return breakers;
+}
+
+CircuitBreaker& CircuitBreaker::forEndpoint(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<CircuitBreaker>& breaker = registry()[name];
+    if (!breaker) {
+        breaker.reset(new CircuitBreaker(name));
+    }
+    return *breaker;
+}
+
+std::vector<CircuitBreaker*> CircuitBreaker::all() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<CircuitBreaker*> breakers;
+    for (auto& entry : registry()) {
+        breakers.push_back(entry.second.get());
+    }
+    return breakers;
+}
+
+const char* CircuitBreaker::stateName(State state) {
+    switch (state) {
+        case OPEN: return "open";
+        case HALF_OPEN: return "half-open";
+        default: return "closed";
+    }
+}
+
+// ========== RETRY POLICY ==========
+
+long long RetryPolicy::backoffMs(int retry) const {
+    long long cap = baseDelayMs;
+    for (int i = 0; i < retry && cap < maxDelayMs; i++) {
+        cap *= 2;
+    }
+    cap = std::min(cap, maxDelayMs);
+    thread_local std::mt19937 rng(std::random_device{}());
+    std::uniform_int_distribution<long long> jitter(0, cap);
+    return jitter(rng);
+}
+
+bool RetryPolicy::isRetriable(const HttpResult& result, bool idempotent) {
+    if (result.rejected) {
+        return false;
+    }
+    if (!result.ok()) {
+        // Connection never established: safe to resend anything
+        if (result.curlCode == CURLE_COULDNT_CONNECT || result.curlCode == CURLE_COULDNT_RESOLVE_HOST) {
+            return true;
+        }
+        return idempotent;
+    }
+    return idempotent && (result.statusCode == 429 || result.statusCode >= 500);
+}
@@ -0,0 +1,97 @@
+#ifndef CIRCUITBREAKER_H
+#define CIRCUITBREAKER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include "AsyncHttp.h"
+
+// Per-endpoint circuit breaker.
+// Keeps the outcome of the last calls to one upstream. When too many of
+// them fail or run slow the breaker opens and callers fail fast instead of
+// paying a connect/timeout each; after a cool-down one probe call is let
+// through (half-open) and its outcome closes or re-opens the breaker.
+class CircuitBreaker {
+public:
+    enum State { CLOSED, OPEN, HALF_OPEN };
+
+    struct Options {
+        size_t window;           // recent calls considered
+        size_t minCalls;         // no verdict on fewer calls than this
+        double failureRate;      // open at this share of failed calls
+        double slowCallMs;
+        double slowCallRate;     // ...or at this share of slow calls
+        int openMs;              // cool-down before the half-open probe
+
+        Options()
+            : window(50), minCalls(10), failureRate(0.5), slowCallMs(10000),
+              slowCallRate(0.8), openMs(5000) {}
+    };
+
+    struct Stats {
+        State state;
+        long long calls;
+        long long failures;
+        long long rejected;      // failed fast while open
+        long long trips;
+        double failureRate;      // over the current window
+
+        Stats() : state(CLOSED), calls(0), failures(0), rejected(0), trips(0), failureRate(0) {}
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string name;
+    Options options;
+    mutable std::mutex mtx;
+    std::vector<unsigned char> outcomes;   // ring: bit 0 = failed, bit 1 = slow
+    size_t next;
+    size_t count;
+    size_t failedInWindow;
+    size_t slowInWindow;
+    State state;
+    Clock::time_point openedAt;
+    bool probeInFlight;
+    Stats stats;
+
+    void record(bool failed, double latencyMs);
+    void open();
+    void resetWindow();
+
+public:
+    explicit CircuitBreaker(const std::string& name, const Options& opts = Options());
+
+    // False = fail fast without calling the upstream
+    bool allow();
+    void onSuccess(double latencyMs);
+    void onFailure(double latencyMs);
+    // Transport errors, 5xx and 429 count as failures
+    void onResult(const HttpResult& result, double latencyMs);
+
+    Stats getStats() const;
+    const std::string& getName() const { return name; }
+
+    // Process-wide breaker per upstream ("groq", "firebase", ...)
+    static CircuitBreaker& forEndpoint(const std::string& name);
+    static std::vector<CircuitBreaker*> all();
+    static const char* stateName(State state);
+};
+
+// Exponential backoff with full jitter for retriable upstream errors
+struct RetryPolicy {
+    int maxAttempts;
+    long long baseDelayMs;
+    long long maxDelayMs;
+
+    RetryPolicy() : maxAttempts(3), baseDelayMs(100), maxDelayMs(2000) {}
+
+    // Random delay in [0, min(max, base * 2^retry)]
+    long long backoffMs(int retry) const;
+
+    // Non-idempotent calls are only retried if the request never left
+    static bool isRetriable(const HttpResult& result, bool idempotent);
+};
+
+#endif // CIRCUITBREAKER_H
@@ -0,0 +1,144 @@
+#include "ConversationWindow.h"
+#include <cstdio>
+
+ConversationWindow::ConversationWindow(size_t tokenBudget, size_t maxTurns)
+    : ring(maxTurns > 0 ? maxTurns : 1), head(0), count(0), tokenBudget(tokenBudget), tokenTotal(0), nextSeq(1) {}
+
+size_t ConversationWindow::estimateTokens(const std::string& text) {
+    return text.size() / 4 + 4;
+}
+
+std::string ConversationWindow::escapeJson(const std::string& str) {
+    std::string escaped;
+    escaped.reserve(str.size() + 8);
+    for (char c : str) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\b': escaped += "\\b"; break;
+            case '\f': escaped += "\\f"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ('\x00' <= c && c <= '\x1f') {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", (int)c);
+                    escaped += buf;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string ConversationWindow::fragment(const std::string& role, const std::string& content) {
+    return "{\"role\":\"" + role + "\",\"content\":\"" + escapeJson(content) + "\"}";
+}
+
+ConversationWindow::Turn& ConversationWindow::slot(size_t i) {
+    return ring[(head + i) % ring.size()];
+}
+
+const ConversationWindow::Turn& ConversationWindow::at(size_t i) const {
+    return ring[(head + i) % ring.size()];
+}
+
+void ConversationWindow::dropOldest() {
+    Turn& oldest = slot(0);
+    tokenTotal -= oldest.tokens;
+    oldest = Turn();
+    head = (head + 1) % ring.size();
+    count--;
+}
+
+void ConversationWindow::trim() {
+    // Always keep the newest turn, even if it alone exceeds the budget
+    while (count > 1 && tokenTotal > tokenBudget) {
+        dropOldest();
+    }
+    // Never open the context with an orphaned assistant reply
+    while (count > 1 && slot(0).role == "assistant") {
+        dropOldest();
+    }
+}
+
+void ConversationWindow::append(const std::string& role, const std::string& content) {
+    if (count == ring.size()) {
+        dropOldest();
+    }
+    Turn& turn = slot(count);
+    turn.role = role;
+    turn.content = content;
+    turn.fragment = fragment(role, content);
+    turn.tokens = estimateTokens(content);
+    turn.seq = nextSeq++;
+    tokenTotal += turn.tokens;
+    count++;
+    trim();
+}
+
+void ConversationWindow::popBack() {
+    if (count == 0) return;
+    Turn& newest = slot(count - 1);
+    tokenTotal -= newest.tokens;
+    newest = Turn();
+    count--;
+}
+
+size_t ConversationWindow::compactable(size_t keepTokens, size_t keepTurns) const {
+    size_t n = 0;
+    size_t remaining = tokenTotal;
+    while (count - n > 2 && (remaining > keepTokens || count - n > keepTurns)) {
+        remaining -= at(n).tokens;
+        n++;
+    }
+    // Never leave an orphaned assistant reply at the front
+    while (n > 0 && count - n > 1 && at(n).role == "assistant") {
+        n++;
+    }
+    return n;
+}
+
+void ConversationWindow::dropThrough(uint64_t seq) {
+    while (count > 0 && slot(0).seq <= seq) {
+        dropOldest();
+    }
+}
+
+void ConversationWindow::clear() {
+    while (count > 0) {
+        dropOldest();
+    }
+    head = 0;
+}
+
+void ConversationWindow::setTokenBudget(size_t budget) {
+    tokenBudget = budget;
+    trim();
+}
+
+size_t ConversationWindow::size() const {
+    return count;
+}
+
+size_t ConversationWindow::capacity() const {
+    return ring.size();
+}
+
+size_t ConversationWindow::tokens() const {
+    return tokenTotal;
+}
+
+size_t ConversationWindow::getTokenBudget() const {
+    return tokenBudget;
+}
+
+void ConversationWindow::appendFragments(std::string& out, uint64_t afterSeq) const {
+    for (size_t i = 0; i < count; i++) {
+        if (at(i).seq <= afterSeq) continue;
+        out += ',';
+        out += at(i).fragment;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef CONVERSATIONWINDOW_H
+#define CONVERSATIONWINDOW_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Bounded ring of chat turns sent to the model as context.
+// Each turn keeps an approximate token count and its pre-escaped JSON
+// message fragment, so trimming is by token budget and building the
+// "messages" array is plain concatenation. Turns are numbered in append
+// order, so a summary can name the turns it covers.
+class ConversationWindow {
+public:
+    struct Turn {
+        std::string role;
+        std::string content;
+        std::string fragment;   // {"role":"...","content":"..."}
+        size_t tokens;
+        uint64_t seq;           // 1-based, never reused
+    };
+
+private:
+    std::vector<Turn> ring;
+    size_t head;                // index of the oldest turn
+    size_t count;
+    size_t tokenBudget;
+    size_t tokenTotal;
+    uint64_t nextSeq;
+
+    Turn& slot(size_t i);
+    void dropOldest();
+    void trim();
+
+public:
+    ConversationWindow(size_t tokenBudget = 4000, size_t maxTurns = 64);
+
+    // Rough estimate (~4 characters per token plus per-message overhead)
+    static size_t estimateTokens(const std::string& text);
+    static std::string escapeJson(const std::string& str);
+    static std::string fragment(const std::string& role, const std::string& content);
+
+    void append(const std::string& role, const std::string& content);
+    void popBack();
+    // How many of the oldest turns must go for at most keepTokens and
+    // keepTurns to remain (the newest exchange always stays); they are
+    // summarized first and dropped with dropThrough once that succeeded
+    size_t compactable(size_t keepTokens, size_t keepTurns) const;
+    void dropThrough(uint64_t seq);
+    void clear();
+    void setTokenBudget(size_t budget);
+
+    // i = 0 is the oldest turn still in the window
+    const Turn& at(size_t i) const;
+    size_t size() const;
+    size_t capacity() const;    // turns held before the oldest is dropped unsummarized
+    size_t tokens() const;
+    size_t getTokenBudget() const;
+
+    // ",fragment" for every turn after afterSeq, oldest first
+    void appendFragments(std::string& out, uint64_t afterSeq = 0) const;
+};
+
+#endif // CONVERSATIONWINDOW_H
@@ -0,0 +1,117 @@
+#include "EpochReclaimer.h"
+#include <limits>
+
+// Per-thread slot and guard depth; the slot is handed back when the thread exits
+struct EpochThreadState {
+    int slot;
+    int depth;
+
+    EpochThreadState() : slot(-2), depth(0) {}  // -2 = not claimed yet, -1 = none free
+    ~EpochThreadState() {
+        if (slot >= 0) EpochReclaimer::shared().releaseSlot(slot);
+    }
+};
+
+static thread_local EpochThreadState threadState;
+
+EpochReclaimer& EpochReclaimer::shared() {
+    static EpochReclaimer instance;
+    return instance;
+}
+
+EpochReclaimer::EpochReclaimer() : globalEpoch(1), overflowReaders(0), reclaimed(0) {
+    for (Slot& slot : slots) {
+        slot.epoch.store(0);
+        slot.owned.store(false);
+    }
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    // No readers are left at static destruction
+    for (auto& item : retired) {
+        item.deleter();
+    }
+}
+
+int EpochReclaimer::claimSlot() {
+    for (int i = 0; i < kSlots; i++) {
+        bool expected = false;
+        if (!slots[i].owned.load(std::memory_order_relaxed) &&
+            slots[i].owned.compare_exchange_strong(expected, true)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void EpochReclaimer::releaseSlot(int index) {
+    slots[index].epoch.store(0);
+    slots[index].owned.store(false);
+}
+
+// All epoch and slot accesses are seq_cst: a reader whose announcement a
+// writer's scan missed must load the pointer after it was replaced
+void EpochReclaimer::enter() {
+    EpochThreadState& state = threadState;
+    if (state.depth++ > 0) return;
+    if (state.slot == -2) state.slot = claimSlot();
+    if (state.slot >= 0) {
+        slots[state.slot].epoch.store(globalEpoch.load());
+    } else {
+        overflowReaders.fetch_add(1);
+    }
+}
+
+void EpochReclaimer::exit() {
+    EpochThreadState& state = threadState;
+    if (--state.depth > 0) return;
+    if (state.slot >= 0) {
+        slots[state.slot].epoch.store(0);
+    } else {
+        overflowReaders.fetch_sub(1);
+    }
+}
+
+void EpochReclaimer::retire(std::function<void()> deleter) {
+    std::unique_lock<std::mutex> lock(retireMutex);
+    retired.push_back({globalEpoch.fetch_add(1), std::move(deleter)});
+    reclaim(lock);
+}
+
+// Frees everything retired before the oldest epoch a reader still holds
+void EpochReclaimer::reclaim(std::unique_lock<std::mutex>& lock) {
+    if (overflowReaders.load() > 0) return;  // unannounced readers: wait for a later pass
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (const Slot& slot : slots) {
+        uint64_t epoch = slot.epoch.load();
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    std::vector<std::function<void()>> ready;
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+        if (retired[i].epoch < oldest) {
+            ready.push_back(std::move(retired[i].deleter));
+        } else {
+            if (kept != i) retired[kept] = std::move(retired[i]);
+            kept++;
+        }
+    }
+    retired.resize(kept);
+    reclaimed += (long long)ready.size();
+
+    lock.unlock();
+    for (auto& deleter : ready) {
+        deleter();
+    }
+    lock.lock();
+}
+
+EpochReclaimer::Stats EpochReclaimer::getStats() const {
+    std::lock_guard<std::mutex> lock(retireMutex);
+    Stats stats;
+    stats.epoch = globalEpoch.load();
+    stats.pending = retired.size();
+    stats.reclaimed = reclaimed;
+    return stats;
+}
@@ -0,0 +1,73 @@
+#ifndef EPOCHRECLAIMER_H
+#define EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for read-mostly structures published through an
+// atomic pointer. Readers announce the epoch they entered in a per-thread
+// slot (one store in, one store out, no shared cache line); writers retire
+// replaced versions and free them once every reader that could still see
+// them has left.
+class EpochReclaimer {
+public:
+    struct Stats {
+        uint64_t epoch;
+        size_t pending;      // retired, waiting for readers to move on
+        long long reclaimed;
+    };
+
+    // Pins the current epoch for the enclosing scope (nests on one thread)
+    class Guard {
+    public:
+        explicit Guard(EpochReclaimer& reclaimer) : owner(reclaimer) { owner.enter(); }
+        ~Guard() { owner.exit(); }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    private:
+        EpochReclaimer& owner;
+    };
+
+    static EpochReclaimer& shared();
+    ~EpochReclaimer();
+
+    // Runs deleter once no reader can still hold what it frees. Call it
+    // after the replacement has been published.
+    void retire(std::function<void()> deleter);
+    Stats getStats() const;
+
+private:
+    static const int kSlots = 256;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch;  // 0 = not reading
+        std::atomic<bool> owned;
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> deleter;
+    };
+
+    Slot slots[kSlots];
+    std::atomic<uint64_t> globalEpoch;
+    std::atomic<int> overflowReaders;  // threads that found no free slot
+
+    mutable std::mutex retireMutex;
+    std::vector<Retired> retired;
+    long long reclaimed;
+
+    EpochReclaimer();
+    void enter();
+    void exit();
+    int claimSlot();
+    void releaseSlot(int index);
+    void reclaim(std::unique_lock<std::mutex>& lock);
+
+    friend struct EpochThreadState;
+};
+
+#endif // EPOCHRECLAIMER_H
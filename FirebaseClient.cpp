@@ -1,11 +1,18 @@
 #include "FirebaseClient.h"
 #include <iostream>
 #include <sstream>
+#include "AsyncHttp.h"
+#include "CircuitBreaker.h"
 #include <curl/curl.h>
 #include <cstring>
+#include <cstdio>
 #include <ctime>
 #include <vector>
 #include <iomanip>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <chrono>
 #include "json.hpp"
 
 using json = nlohmann::json;
@@ -34,12 +41,47 @@ std::string escapeJsonString(const std::string& str) {
     return escaped.str();
 }
 
-// CURL write callback for response data
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* data) {
-    size_t totalSize = size * nmemb;
-    data->append((char*)contents, totalSize);
-    return totalSize;
-}
+// SAX walk of {userId: {keyword: {"response": text}}}; nothing but the
+// current keys is kept, so the whole index never becomes a DOM
+class ResponseIndexHandler : public nlohmann::json_sax<json> {
+public:
+    typedef std::function<void(const std::string&, const std::string&, const std::string&)> Callback;
+    explicit ResponseIndexHandler(const Callback& cb) : onEntry(cb), depth(0) {}
+    
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+    bool string(string_t& val) override {
+        if (depth == 3 && lastKey == "response") {
+            onEntry(userId, keyword, val);
+        } else if (depth == 2) {
+            onEntry(userId, lastKey, val);  // bare {keyword: text}
+        }
+        return true;
+    }
+    bool start_object(std::size_t) override { depth++; return true; }
+    bool end_object() override { depth--; return true; }
+    bool start_array(std::size_t) override { depth++; return true; }
+    bool end_array() override { depth--; return true; }
+    bool key(string_t& val) override {
+        if (depth == 1) userId = val;
+        if (depth == 2) keyword = val;
+        lastKey = val;
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        std::cerr << "[Firebase] Response index parse error: " << ex.what() << std::endl;
+        return false;
+    }
+    
+private:
+    const Callback& onEntry;
+    int depth;
+    std::string userId, keyword, lastKey;
+};
 
 FirebaseClient::FirebaseClient(const std::string& url, const std::string& key) 
     : firebaseUrl(url), apiKey(key), authToken("") {
@@ -59,102 +101,59 @@ std::string FirebaseClient::buildUrl(const std::string& path) const {
     return url.str();
 }
 
-std::string FirebaseClient::httpGet(const std::string& url) const {
-    CURL* curl = curl_easy_init();
-    std::string response;
-    
-    if (curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        }
-        
-        curl_easy_cleanup(curl);
+// All transfers run on the shared curl_multi event loop (AsyncHttp)
+HttpRequest FirebaseClient::makeRequest(const std::string& method, const std::string& url,
+                                        const std::string& data) const {
+    HttpRequest req;
+    req.method = method;
+    req.url = url;
+    req.body = data;
+    req.timeoutMs = 15000;
+    if (!data.empty()) {
+        req.headers.push_back("Content-Type: application/json");
     }
-    
-    return response;
+    return req;
 }
 
-std::string FirebaseClient::httpPost(const std::string& url, const std::string& data) const {
-    CURL* curl = curl_easy_init();
-    std::string response;
-    
-    if (curl) {
-        struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+// Failing upstreams trip the "firebase" breaker; retriable errors back off and retry
+std::string FirebaseClient::send(const HttpRequest& req) const {
+    CircuitBreaker& breaker = CircuitBreaker::forEndpoint("firebase");
+    RetryPolicy retry;
+    bool idempotent = req.method != "POST";
+    HttpResult result;
+    for (int attempt = 0; ; attempt++) {
+        if (!breaker.allow()) {
+            std::cerr << "[Firebase] Circuit open, failing fast: " << req.method << std::endl;
+            return "";
         }
-        
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+        result = AsyncHttp::shared().perform(req);
+        breaker.onResult(result, result.elapsedMs);
+        if (!RetryPolicy::isRetriable(result, idempotent) || attempt + 1 >= retry.maxAttempts) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(retry.backoffMs(attempt)));
     }
-    
-    return response;
+    if (!result.ok()) {
+        std::cerr << "curl_easy_perform() failed: " << result.error() << std::endl;
+    }
+    return result.body;
+}
+
+std::string FirebaseClient::httpGet(const std::string& url) const {
+    // App refreshes often ask for the same path at once; share one read
+    return readFlight.run(url, [this, &url]() {
+        return send(makeRequest("GET", url, ""));
+    });
+}
+
+std::string FirebaseClient::httpPost(const std::string& url, const std::string& data) const {
+    return send(makeRequest("POST", url, data));
 }
 
 std::string FirebaseClient::httpPut(const std::string& url, const std::string& data) const {
-    CURL* curl = curl_easy_init();
-    std::string response;
-    
-    if (curl) {
-        struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        }
-        
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-    }
-    
-    return response;
+    return send(makeRequest("PUT", url, data));
 }
 
 std::string FirebaseClient::httpDelete(const std::string& url) const {
-    CURL* curl = curl_easy_init();
-    std::string response;
-    
-    if (curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        }
-        
-        curl_easy_cleanup(curl);
-    }
-    
-    return response;
+    return send(makeRequest("DELETE", url, ""));
 }
 
 bool FirebaseClient::authenticate(const std::string& email, const std::string& password) {
@@ -205,6 +204,107 @@ bool FirebaseClient::saveMessage(const Message& message, const std::string& user
 
 
 
+void FirebaseClient::saveMessagesAsync(const std::vector<Message>& messages, const std::string& userId) {
+    if (messages.empty()) return;
+
+    // Build every payload up front; the event loop outlives this call
+    auto payloads = std::make_shared<std::vector<HttpRequest>>();
+    std::string url = buildUrl("/users/" + userId + "/messages.json");
+    for (const auto& message : messages) {
+        std::ostringstream json;
+        json << "{"
+             << "\"content\":\"" << escapeJsonString(message.content) << "\","
+             << "\"sender\":\"" << escapeJsonString(message.sender) << "\","
+             << "\"timestamp\":\"" << escapeJsonString(message.timestamp) << "\""
+             << "}";
+        payloads->push_back(makeRequest("POST", url, json.str()));
+    }
+
+    // Fire-and-forget, chained so Firebase push IDs keep the conversation order
+    auto next = std::make_shared<std::function<void(size_t)>>();
+    std::weak_ptr<std::function<void(size_t)>> weakNext = next;
+    *next = [payloads, weakNext, userId](size_t index) {
+        auto self = weakNext.lock();
+        CircuitBreaker& breaker = CircuitBreaker::forEndpoint("firebase");
+        if (!breaker.allow()) {
+            std::cerr << "[Firebase] Circuit open, dropping " << payloads->size() - index
+                      << " async saves for " << userId << std::endl;
+            return;
+        }
+        AsyncHttp::shared().submit((*payloads)[index], [payloads, self, userId, index, &breaker](HttpResult result) {
+            breaker.onResult(result, result.elapsedMs);
+            if (!result.ok() || result.body.find("error") != std::string::npos) {
+                std::cerr << "[Firebase] Async save failed for " << userId << ": "
+                          << (result.ok() ? result.body : result.error()) << std::endl;
+            }
+            if (index + 1 < payloads->size()) {
+                (*self)(index + 1);
+            }
+        });
+    };
+    (*next)(0);
+}
+
+// A 4xx other than 408/429 (bad key, rules, payload) fails the same way on
+// every retry; anything else may go through later
+static bool isRetriableWrite(const HttpResult& result) {
+    if (!result.ok()) return true;
+    long code = result.statusCode;
+    return code < 400 || code >= 500 || code == 408 || code == 429;
+}
+
+void FirebaseClient::patchMessagesAsync(const std::string& userId,
+                                        const std::vector<std::pair<std::string, Message>>& messages,
+                                        std::function<void(bool, bool)> done) {
+    CircuitBreaker& breaker = CircuitBreaker::forEndpoint("firebase");
+    if (messages.empty() || !breaker.allow()) {
+        done(messages.empty(), true);
+        return;
+    }
+
+    std::ostringstream json;
+    json << "{";
+    for (size_t i = 0; i < messages.size(); i++) {
+        const Message& message = messages[i].second;
+        json << (i > 0 ? "," : "") << "\"" << escapeJsonString(messages[i].first) << "\":{"
+             << "\"content\":\"" << escapeJsonString(message.content) << "\","
+             << "\"sender\":\"" << escapeJsonString(message.sender) << "\","
+             << "\"timestamp\":\"" << escapeJsonString(message.timestamp) << "\""
+             << "}";
+    }
+    json << "}";
+
+    HttpRequest req = makeRequest("PATCH", buildUrl("/users/" + userId + "/messages.json"), json.str());
+    AsyncHttp::shared().submit(req, [&breaker, done, userId](HttpResult result) {
+        breaker.onResult(result, result.elapsedMs);
+        bool ok = result.ok() && result.statusCode >= 200 && result.statusCode < 300;
+        if (!ok) {
+            std::cerr << "[Firebase] Replication failed for " << userId << ": "
+                      << (result.ok() ? result.body : result.error()) << std::endl;
+        }
+        done(ok, isRetriableWrite(result));
+    });
+}
+
+void FirebaseClient::deleteMessagesAsync(const std::string& userId, std::function<void(bool, bool)> done) {
+    CircuitBreaker& breaker = CircuitBreaker::forEndpoint("firebase");
+    if (!breaker.allow()) {
+        done(false, true);
+        return;
+    }
+
+    HttpRequest req = makeRequest("DELETE", buildUrl("/users/" + userId + "/messages.json"), "");
+    AsyncHttp::shared().submit(req, [&breaker, done, userId](HttpResult result) {
+        breaker.onResult(result, result.elapsedMs);
+        bool ok = result.ok() && result.statusCode >= 200 && result.statusCode < 300;
+        if (!ok) {
+            std::cerr << "[Firebase] Replicated clear failed for " << userId << ": "
+                      << (result.ok() ? result.body : result.error()) << std::endl;
+        }
+        done(ok, isRetriableWrite(result));
+    });
+}
+
 std::vector<Message> FirebaseClient::getMessages(const std::string& userId, int limit) {
     std::vector<Message> messages;
 
@@ -251,14 +351,16 @@ std::vector<Message> FirebaseClient::getMessages(const std::string& userId, int
 
 bool FirebaseClient::saveUserResponse(const std::string& keyword, const std::string& response, 
                                      const std::string& userId) {
+    // One multi-path update writes the user's copy and the /responses index
+    // that startup bulk-loads, so the two never disagree
+    std::string value = "{\"response\":\"" + escapeJsonString(response) + "\"}";
     std::ostringstream json;
-    json << "{\"response\":\"" << escapeJsonString(response) << "\"}";
+    json << "{\"users/" << escapeJsonString(userId) << "/customResponses/" << escapeJsonString(keyword) << "\":" << value
+         << ",\"responses/" << escapeJsonString(userId) << "/" << escapeJsonString(keyword) << "\":" << value << "}";
     
-    std::string path = "/users/" + userId + "/customResponses/" + keyword + ".json";
     // Note: auth token is added by buildUrl()
-    
-    std::string url = buildUrl(path);
-    std::string result = httpPut(url, json.str());
+    std::string url = buildUrl("/.json");
+    std::string result = send(makeRequest("PATCH", url, json.str()));
     
     return !result.empty() && result.find("error") == std::string::npos;
 }
@@ -290,6 +392,91 @@ std::vector<std::pair<std::string, std::string>> FirebaseClient::getUserResponse
     return responses;
 }
 
+bool FirebaseClient::loadAllUserResponses(const std::function<void(const std::string&, const std::string&,
+                                                                   const std::string&)>& onEntry) {
+    HttpRequest req = makeRequest("GET", buildUrl("/responses.json"), "");
+    req.timeoutMs = 60000;  // the whole index, not one user
+    if (!CircuitBreaker::forEndpoint("firebase").allow()) return false;
+    HttpResult result = AsyncHttp::shared().perform(req);
+    CircuitBreaker::forEndpoint("firebase").onResult(result, result.elapsedMs);
+    if (!result.ok() || result.statusCode < 200 || result.statusCode >= 300) {
+        std::cerr << "[Firebase] Response index fetch failed: "
+                  << (result.ok() ? result.body : result.error()) << std::endl;
+        return false;
+    }
+    if (result.body == "null") return true;
+    
+    ResponseIndexHandler handler(onEntry);
+    return json::sax_parse(result.body, &handler);
+}
+
+// Stable Firebase key for an article: FNV-1a 64 of its URL
+static std::string articleKey(const std::string& url) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (char c : url) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ULL;
+    }
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", hash);
+    return std::string(buf);
+}
+
+void FirebaseClient::storeNewsArticles(const std::vector<GuardianAPI::NewsArticle>& articles) {
+    json batch = json::object();
+    long long now = (long long)time(nullptr);
+    for (const auto& article : articles) {
+        if (article.url.empty()) continue;
+        batch[articleKey(article.url)] = {
+            {"title", article.title},
+            {"url", article.url},
+            {"section", article.section},
+            {"date", article.date},
+            {"timestamp", now},
+            {"source", "The Guardian"}
+        };
+    }
+    CircuitBreaker& breaker = CircuitBreaker::forEndpoint("firebase");
+    if (batch.empty() || !breaker.allow()) return;
+    
+    HttpRequest req = makeRequest("PATCH", buildUrl("/news/articles.json"), batch.dump());
+    AsyncHttp::shared().submit(req, [&breaker](HttpResult result) {
+        breaker.onResult(result, result.elapsedMs);
+        if (!result.ok() || result.statusCode < 200 || result.statusCode >= 300) {
+            std::cerr << "[Firebase] News store failed: "
+                      << (result.ok() ? result.body : result.error()) << std::endl;
+        }
+    });
+}
+
+bool FirebaseClient::loadNewsArticles(const std::function<void(const std::string&, const std::string&,
+                                                               const std::string&, const std::string&)>& onArticle) {
+    HttpRequest req = makeRequest("GET", buildUrl("/news/articles.json"), "");
+    req.timeoutMs = 60000;
+    if (!CircuitBreaker::forEndpoint("firebase").allow()) return false;
+    HttpResult result = AsyncHttp::shared().perform(req);
+    CircuitBreaker::forEndpoint("firebase").onResult(result, result.elapsedMs);
+    if (!result.ok() || result.statusCode < 200 || result.statusCode >= 300) {
+        std::cerr << "[Firebase] News fetch failed: "
+                  << (result.ok() ? result.body : result.error()) << std::endl;
+        return false;
+    }
+    if (result.body == "null") return true;
+    
+    json articles = json::parse(result.body, nullptr, false);
+    if (!articles.is_object()) return false;
+    for (auto it = articles.begin(); it != articles.end(); ++it) {
+        const json& a = it.value();
+        if (!a.is_object()) continue;
+        auto field = [&a](const char* name) {
+            auto f = a.find(name);
+            return f != a.end() && f->is_string() ? f->get<std::string>() : std::string();
+        };
+        onArticle(field("title"), field("url"), field("section"), field("date"));
+    }
+    return true;
+}
+
 bool FirebaseClient::clearUserHistory(const std::string& userId) {
     std::string path = "/users/" + userId + "/messages.json";
     // Note: auth token is added by buildUrl()
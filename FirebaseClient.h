@@ -4,7 +4,11 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 #include "Chatbot.h"
+#include "GuardianAPI.h"
+#include "AsyncHttp.h"
+#include "SingleFlight.h"
 
 // Firebase REST API Client
 class FirebaseClient {
@@ -12,8 +16,11 @@ private:
     std::string firebaseUrl;
     std::string apiKey;
     std::string authToken;
+    mutable SingleFlight<std::string> readFlight;  // coalesces identical GETs
     
     // Helper functions for HTTP requests
+    HttpRequest makeRequest(const std::string& method, const std::string& url, const std::string& data) const;
+    std::string send(const HttpRequest& req) const;
     std::string httpGet(const std::string& url) const;
     std::string httpPost(const std::string& url, const std::string& data) const;
     std::string httpPut(const std::string& url, const std::string& data) const;
@@ -30,14 +37,36 @@ public:
     
     // Database operations
     bool saveMessage(const Message& message, const std::string& userId);
+    void saveMessagesAsync(const std::vector<Message>& messages, const std::string& userId);
+    // Idempotent batch write under caller-chosen keys (one PATCH); done(ok, retriable)
+    // runs on the I/O loop, retriable false when Firebase refused the write itself
+    void patchMessagesAsync(const std::string& userId, const std::vector<std::pair<std::string, Message>>& messages,
+                            std::function<void(bool, bool)> done);
+    // Deletes the user's messages; done(ok, retriable) as above
+    void deleteMessagesAsync(const std::string& userId, std::function<void(bool, bool)> done);
     std::vector<Message> getMessages(const std::string& userId, int limit = 50);
     bool saveUserResponse(const std::string& keyword, const std::string& response, const std::string& userId);
     std::vector<std::pair<std::string, std::string>> getUserResponses(const std::string& userId);
+    // Every user's custom responses in one GET of the /responses index;
+    // onEntry(userId, keyword, response) runs per entry. False if the fetch failed.
+    bool loadAllUserResponses(const std::function<void(const std::string&, const std::string&,
+                                                       const std::string&)>& onEntry);
+    // Fresh Guardian articles in one multi-path PATCH of /news/articles, keyed
+    // by URL so re-storing overwrites; fire-and-forget on the I/O loop
+    void storeNewsArticles(const std::vector<GuardianAPI::NewsArticle>& articles);
+    // Every stored news article in one GET of /news/articles;
+    // onArticle(title, url, section, date) runs per article. False if the fetch failed.
+    bool loadNewsArticles(const std::function<void(const std::string&, const std::string&,
+                                                   const std::string&, const std::string&)>& onArticle);
     bool clearUserHistory(const std::string& userId);
     
     // User management
     bool createUser(const std::string& userId, const std::string& email);
     bool userExists(const std::string& userId);
+    
+    // Read coalescing counters
+    long long getReadsExecuted() const { return readFlight.getExecuted(); }
+    long long getReadsCoalesced() const { return readFlight.getCoalesced(); }
 };
 
 #endif // FIREBASECLIENT_H
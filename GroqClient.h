@@ -5,171 +5,622 @@
 #include <vector>
 #include <curl/curl.h>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <functional>
 #include "json.hpp"
+#include "AsyncHttp.h"
+#include "ResponseCache.h"
+#include "SemanticCache.h"
+#include "ConversationWindow.h"
+#include "SingleFlight.h"
+#include "LatencyTracker.h"
+#include "CircuitBreaker.h"
 
 using json = nlohmann::json;
 
 class GroqClient {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    struct HedgeStats {
+        long long hedged;            // second attempts fired
+        long long hedgeWins;         // ...that answered first
+        long long deadlineExceeded;  // calls abandoned at the caller's deadline
+        double p95Ms;
+        
+        HedgeStats() : hedged(0), hedgeWins(0), deadlineExceeded(0), p95Ms(0) {}
+    };
+    
+    typedef std::vector<std::pair<std::string, std::string>> Turns;  // role, content
+    // Fills a new session from persisted state; false if there is none
+    typedef std::function<bool(const std::string& userId, Turns& turns, std::string& summary)> SessionSeed;
+    typedef std::function<void(const std::string& userId, const Turns& turns, const std::string& summary)> SessionVisitor;
+    
 private:
     std::string apiKey;
     std::string model;
     std::string baseUrl;
-    std::vector<std::pair<std::string, std::string>> conversationHistory; // role, content pairs
-    
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-        ((std::string*)userp)->append((char*)contents, size * nmemb);
-        return size * nmemb;
-    }
-    
-    std::string escapeJsonString(const std::string& str) {
-        std::ostringstream escaped;
-        for (char c : str) {
-            switch (c) {
-                case '"': escaped << "\\\""; break;
-                case '\\': escaped << "\\\\"; break;
-                case '\b': escaped << "\\b"; break;
-                case '\f': escaped << "\\f"; break;
-                case '\n': escaped << "\\n"; break;
-                case '\r': escaped << "\\r"; break;
-                case '\t': escaped << "\\t"; break;
-                default:
-                    if ('\x00' <= c && c <= '\x1f') {
-                        escaped << "\\u" << std::hex << std::setfill('0') << std::setw(4) << (int)c;
-                    } else {
-                        escaped << c;
-                    }
+    const std::string systemPrompt;     // immutable and shared by every session
+    const std::string systemFragment;   // pre-escaped system message
+    ResponseCache cache;  // exact-match completions
+    SemanticCache semanticCache;  // paraphrases of earlier prompts, same context
+    
+    // Long-range memory: the oldest window turns, summarized by a background
+    // call. Shared with the in-flight callback so it outlives us.
+    struct Memory {
+        std::mutex mtx;
+        std::string summary;
+        std::string fragment;     // pre-escaped system message, empty until summarized
+        uint64_t summarizedThrough;   // window turns up to this seq are in the summary
+        bool compacting;
+        unsigned generation;      // bumped by clearHistory to drop stale summaries
+        
+        Memory() : summarizedThrough(0), compacting(false), generation(0) {}
+    };
+    
+    // One user's conversation. The session mutex only orders that user's
+    // own requests; different users never wait on each other.
+    struct Session {
+        std::mutex mtx;
+        ConversationWindow window;    // user/assistant turns, bounded by token budget
+        std::shared_ptr<Memory> memory;
+        std::atomic<long long> lastUsedMs;
+        
+        explicit Session(size_t tokenBudget)
+            : window(tokenBudget), memory(std::make_shared<Memory>()), lastUsedMs(0) {}
+    };
+    
+    // userId -> Session, split over independently locked shards
+    struct Shard {
+        std::mutex mtx;
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+    };
+    static const size_t kShardCount = 16;
+    Shard shards[kShardCount];
+    size_t maxSessionsPerShard;
+    std::atomic<size_t> tokenBudget;
+    std::atomic<size_t> compactThreshold;  // window tokens that trigger compaction (0 = off)
+    SessionSeed seed;
+    
+    // Upstream latency and hedging counters. Shared with in-flight
+    // callbacks: a losing attempt may finish after we are gone.
+    struct UpstreamStats {
+        LatencyTracker latency;       // successful upstream completions
+        std::atomic<long long> hedged;
+        std::atomic<long long> hedgeWins;
+        std::atomic<long long> deadlineExceeded;
+        
+        UpstreamStats() : hedged(0), hedgeWins(0), deadlineExceeded(0) {}
+    };
+    std::shared_ptr<UpstreamStats> upstream;
+    std::atomic<bool> hedging;
+    
+    // Wait this long before hedging: recent p95, or a conservative guess
+    // until enough samples exist
+    Clock::duration hedgeDelay() const {
+        double ms = upstream->latency.size() >= 20 ? upstream->latency.percentile(0.95) : 3000.0;
+        return std::chrono::milliseconds((long long)std::max(ms, 250.0));
+    }
+    
+    static long long remainingMs(Clock::time_point deadline) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    }
+    
+    // Upstream call bounded by the caller's deadline. If the first attempt
+    // outlives the hedge delay, an identical second attempt is sent and the
+    // first good answer wins; the loser is left to finish on the event loop.
+    HttpResult performHedged(HttpRequest req, Clock::time_point deadline) {
+        struct Race {
+            std::mutex mtx;
+            std::condition_variable cv;
+            bool done;
+            int outstanding;
+            HttpResult result;
+            
+            Race() : done(false), outstanding(0) {}
+        };
+        std::shared_ptr<Race> race = std::make_shared<Race>();
+        std::shared_ptr<UpstreamStats> stats = upstream;
+        
+        auto launch = [&](int attempt) {
+            req.timeoutMs = std::max(1LL, remainingMs(deadline));
+            {
+                std::lock_guard<std::mutex> lock(race->mtx);
+                race->outstanding++;
+            }
+            AsyncHttp::shared().submit(req, [race, stats, attempt](HttpResult result) {
+                bool good = result.ok() && result.statusCode < 500;
+                if (good) stats->latency.record(result.elapsedMs);
+                std::lock_guard<std::mutex> lock(race->mtx);
+                race->outstanding--;
+                if (race->done || (!good && race->outstanding > 0)) return;
+                if (good && attempt > 0) stats->hedgeWins++;
+                race->result = std::move(result);
+                race->done = true;
+                race->cv.notify_all();
+            });
+        };
+        
+        launch(0);
+        std::unique_lock<std::mutex> lock(race->mtx);
+        auto finished = [&race]() { return race->done; };
+        
+        Clock::time_point hedgeAt = std::min(deadline, Clock::now() + hedgeDelay());
+        if (hedging && hedgeAt < deadline && !race->cv.wait_until(lock, hedgeAt, finished)) {
+            lock.unlock();
+            upstream->hedged++;
+            std::cerr << "[Groq] No answer after p95, sending hedged request" << std::endl;
+            launch(1);
+            lock.lock();
+        }
+        
+        if (!race->cv.wait_until(lock, deadline, finished)) {
+            upstream->deadlineExceeded++;
+            std::cerr << "[Groq] Deadline reached, giving up on upstream" << std::endl;
+            HttpResult timedOut;
+            timedOut.curlCode = CURLE_OPERATION_TIMEDOUT;
+            return timedOut;
+        }
+        return race->result;
+    }
+    
+    // Breaker-guarded call with jittered exponential backoff. Chat completions
+    // have no side effects, so timeouts and 5xx/429 are retried while the
+    // deadline leaves room for another attempt.
+    HttpResult callUpstream(const HttpRequest& req, Clock::time_point deadline) {
+        CircuitBreaker& breaker = CircuitBreaker::forEndpoint("groq");
+        RetryPolicy retry;
+        for (int attempt = 0; ; attempt++) {
+            if (!breaker.allow()) {
+                HttpResult rejected;
+                rejected.rejected = true;
+                return rejected;
             }
+            
+            Clock::time_point started = Clock::now();
+            HttpResult result = performHedged(req, deadline);
+            double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+            breaker.onResult(result, elapsedMs);
+            
+            if (!RetryPolicy::isRetriable(result, true) || attempt + 1 >= retry.maxAttempts) return result;
+            long long waitMs = retry.backoffMs(attempt);
+            if (remainingMs(deadline) <= waitMs) return result;
+            std::cerr << "[Groq] Retrying in " << waitMs << " ms" << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
         }
-        return escaped.str();
+    }
+    
+    static long long nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    Shard& shardFor(const std::string& userId) {
+        return shards[std::hash<std::string>()(userId) % kShardCount];
+    }
+    
+    // Find or create the user's session; a full shard drops its idlest one
+    std::shared_ptr<Session> session(const std::string& userId) {
+        Shard& shard = shardFor(userId);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.sessions.find(userId);
+        if (it == shard.sessions.end()) {
+            if (shard.sessions.size() >= maxSessionsPerShard) {
+                auto idlest = shard.sessions.begin();
+                for (auto jt = shard.sessions.begin(); jt != shard.sessions.end(); ++jt) {
+                    if (jt->second->lastUsedMs < idlest->second->lastUsedMs) idlest = jt;
+                }
+                shard.sessions.erase(idlest);
+            }
+            it = shard.sessions.emplace(userId, std::make_shared<Session>(tokenBudget)).first;
+            if (seed) seedSession(userId, *it->second);
+        }
+        it->second->lastUsedMs = nowMs();
+        return it->second;
+    }
+    
+    void seedSession(const std::string& userId, Session& s) {
+        Turns turns;
+        std::string summary;
+        if (!seed(userId, turns, summary)) return;
+        for (const auto& turn : turns) {
+            s.window.append(turn.first, turn.second);
+        }
+        if (!summary.empty()) {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            s.memory->summary = summary;
+            s.memory->fragment = ConversationWindow::fragment("system",
+                "Summary of the earlier conversation: " + summary);
+        }
+    }
+    
+    static std::string defaultSystemPrompt() {
+        // Sets the chatbot personality and is sent with every request
+        return "You are a helpful, friendly AI assistant. Keep your responses concise and helpful. "
+               "You can help with general questions, coding, explanations, and casual conversation.";
+    }
+    
+    // Everything a cached answer depends on besides the new message: model,
+    // system prompt, summary and the last few turns
+    std::string buildContext(const Session& s) const {
+        std::string material = model;
+        material += '\x1f';
+        material += systemPrompt;
+        {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            material += '\x1f';
+            material += s.memory->summary;
+        }
+        size_t first = s.window.size() > 4 ? s.window.size() - 4 : 0;
+        for (size_t i = first; i < s.window.size(); i++) {
+            const ConversationWindow::Turn& turn = s.window.at(i);
+            material += '\x1f';
+            material += turn.role;
+            material += ':';
+            material += ResponseCache::normalize(turn.content);
+        }
+        return material;
+    }
+    
+    // Cache key: the context plus the new message
+    static std::string buildCacheKey(const std::string& context, const std::string& userMessage) {
+        return ResponseCache::hashKey(context + '\x1f' + ResponseCache::normalize(userMessage));
+    }
+    
+    // Request body from cached fragments; nothing is re-escaped per call
+    std::string buildRequestBody(const Session& s) const {
+        std::string body;
+        body.reserve(64 + model.size() + systemFragment.size() + s.window.tokens() * 5);
+        body += "{\"model\":\"";
+        body += model;
+        body += "\",\"messages\":[";
+        body += systemFragment;
+        uint64_t summarized;
+        {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            if (!s.memory->fragment.empty()) {
+                body += ',';
+                body += s.memory->fragment;
+            }
+            summarized = s.memory->summarizedThrough;
+        }
+        s.window.appendFragments(body, summarized);
+        body += "]}";
+        return body;
+    }
+    
+    // Drops the turns a finished summary now covers; caller holds s.mtx
+    static void foldSummarized(Session& s) {
+        uint64_t summarized;
+        {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            summarized = s.memory->summarizedThrough;
+        }
+        s.window.dropThrough(summarized);
+    }
+    
+    // Once the window passes the token threshold, or fills three quarters of
+    // its turns (short messages), fold its older half into the running
+    // summary with a background call; the reply is not delayed. The turns
+    // stay in the window until the summary arrives, so a failed call loses
+    // nothing and the next turn tries again.
+    void maybeCompact(Session& s) {
+        foldSummarized(s);
+        size_t threshold = compactThreshold;
+        size_t turnLimit = s.window.capacity() * 3 / 4;
+        if (threshold == 0 || (s.window.tokens() <= threshold && s.window.size() < turnLimit)) return;
+        
+        std::string previousSummary;
+        unsigned generation;
+        {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            if (s.memory->compacting) return;
+            s.memory->compacting = true;
+            previousSummary = s.memory->summary;
+            generation = s.memory->generation;
+        }
+        
+        size_t fold = s.window.compactable(threshold / 2, s.window.capacity() / 2);
+        if (fold == 0) {
+            std::lock_guard<std::mutex> lock(s.memory->mtx);
+            s.memory->compacting = false;
+            return;
+        }
+        uint64_t through = s.window.at(fold - 1).seq;
+        
+        std::string transcript;
+        if (!previousSummary.empty()) {
+            transcript += "Earlier summary: " + previousSummary + "\n\n";
+        }
+        for (size_t i = 0; i < fold; i++) {
+            transcript += s.window.at(i).role + ": " + s.window.at(i).content + "\n";
+        }
+        
+        std::string body = "{\"model\":\"" + model + "\",\"max_tokens\":300,\"messages\":[" +
+            ConversationWindow::fragment("system",
+                "Summarize this conversation for your own future reference in under 150 words. "
+                "Keep facts about the user, their goals and any decisions made; drop small talk.") +
+            "," + ConversationWindow::fragment("user", transcript) + "]}";
+        
+        HttpRequest req;
+        req.method = "POST";
+        req.url = baseUrl;
+        req.body = body;
+        req.headers.push_back("Content-Type: application/json");
+        req.headers.push_back("Authorization: Bearer " + apiKey);
+        req.timeoutMs = 30000;
+        
+        std::cerr << "[Groq] Compacting " << fold << " turns into session memory" << std::endl;
+        
+        std::shared_ptr<Memory> mem = s.memory;
+        AsyncHttp::shared().submit(req, [mem, generation, through](HttpResult result) {
+            std::string summary;
+            if (result.ok()) {
+                try {
+                    json responseJson = json::parse(result.body);
+                    if (responseJson.contains("choices") && !responseJson["choices"].empty()) {
+                        summary = responseJson["choices"][0]["message"]["content"].get<std::string>();
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[Groq] Summary parse error: " << e.what() << std::endl;
+                }
+            }
+            
+            std::lock_guard<std::mutex> lock(mem->mtx);
+            mem->compacting = false;
+            if (summary.empty()) {
+                std::cerr << "[Groq] Compaction failed, keeping the turns in the window" << std::endl;
+                return;
+            }
+            if (mem->generation != generation) return;  // history was cleared meanwhile
+            mem->summary = summary;
+            mem->summarizedThrough = through;
+            mem->fragment = ConversationWindow::fragment("system",
+                "Summary of the earlier conversation: " + summary);
+        });
     }
 
 public:
     GroqClient(const std::string& key, const std::string& modelName = "llama-3.3-70b-versatile") 
-        : apiKey(key), model(modelName), baseUrl("https://api.groq.com/openai/v1/chat/completions") {
-        // Add system prompt to set chatbot personality
-        conversationHistory.push_back({
-            "system", 
-            "You are a helpful, friendly AI assistant. Keep your responses concise and helpful. "
-            "You can help with general questions, coding, explanations, and casual conversation."
-        });
+        : apiKey(key), model(modelName), baseUrl("https://api.groq.com/openai/v1/chat/completions"),
+          systemPrompt(defaultSystemPrompt()),
+          systemFragment(ConversationWindow::fragment("system", systemPrompt)),
+          maxSessionsPerShard(1024), tokenBudget(4000), compactThreshold(3000),
+          upstream(std::make_shared<UpstreamStats>()), hedging(true) {}
+    
+    // Sessions created after this are filled lazily from persisted state
+    void setSessionSeed(SessionSeed fn) {
+        seed = fn;
+    }
+    
+    // Visits every live session (for snapshots)
+    void exportSessions(const SessionVisitor& visit) {
+        for (Shard& shard : shards) {
+            std::vector<std::pair<std::string, std::shared_ptr<Session>>> live;
+            {
+                std::lock_guard<std::mutex> lock(shard.mtx);
+                live.assign(shard.sessions.begin(), shard.sessions.end());
+            }
+            for (const auto& entry : live) {
+                Turns turns;
+                std::string summary;
+                uint64_t summarized;
+                {
+                    std::lock_guard<std::mutex> lock(entry.second->memory->mtx);
+                    summary = entry.second->memory->summary;
+                    summarized = entry.second->memory->summarizedThrough;
+                }
+                {
+                    // Turns the summary already covers are left out
+                    std::lock_guard<std::mutex> lock(entry.second->mtx);
+                    const ConversationWindow& window = entry.second->window;
+                    for (size_t i = 0; i < window.size(); i++) {
+                        if (window.at(i).seq <= summarized) continue;
+                        turns.push_back({window.at(i).role, window.at(i).content});
+                    }
+                }
+                visit(entry.first, turns, summary);
+            }
+        }
+    }
+    
+    // Seed a user's context from persisted history (no upstream call)
+    void restoreTurn(const std::string& userId, const std::string& role, const std::string& content) {
+        std::shared_ptr<Session> sp = session(userId);
+        std::lock_guard<std::mutex> lock(sp->mtx);
+        sp->window.append(role, content);
+    }
+    
+    // Forget one user's context; a summary still in flight is discarded
+    void clearHistory(const std::string& userId) {
+        Shard& shard = shardFor(userId);
+        std::shared_ptr<Session> removed;
+        {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto it = shard.sessions.find(userId);
+            if (it == shard.sessions.end()) return;
+            removed = it->second;
+            shard.sessions.erase(it);
+        }
+        std::lock_guard<std::mutex> lock(removed->memory->mtx);
+        removed->memory->generation++;
     }
     
     void clearHistory() {
-        // Keep system prompt, clear user/assistant messages
-        if (!conversationHistory.empty()) {
-            auto systemPrompt = conversationHistory[0];
-            conversationHistory.clear();
-            conversationHistory.push_back(systemPrompt);
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            for (auto& entry : shard.sessions) {
+                std::lock_guard<std::mutex> memLock(entry.second->memory->mtx);
+                entry.second->memory->generation++;
+            }
+            shard.sessions.clear();
         }
     }
     
-    std::string sendMessage(const std::string& userMessage) {
-        CURL* curl;
-        CURLcode res;
-        std::string readBuffer;
+    // Returns "" if no answer arrived before the deadline (default: curl's 30s)
+    std::string sendMessage(const std::string& userId, const std::string& userMessage, bool useCache = true,
+                            Clock::time_point deadline = Clock::time_point::max()) {
+        if (deadline == Clock::time_point::max()) {
+            deadline = Clock::now() + std::chrono::seconds(30);
+        }
+
+        std::shared_ptr<Session> sp = session(userId);
+        Session& s = *sp;
+        std::lock_guard<std::mutex> sessionLock(s.mtx);
+        foldSummarized(s);
         
-        // Add user message to history
-        conversationHistory.push_back({"user", userMessage});
+        std::string context = buildContext(s);
+        std::string cacheKey = buildCacheKey(context, userMessage);
+        uint64_t contextId = std::hash<std::string>()(context);
+        std::string cached;
+        bool exactHit = useCache && cache.get(cacheKey, cached);
+        if (exactHit || (useCache && semanticCache.get(contextId, userMessage, cached))) {
+            std::cerr << "[Groq] " << (exactHit ? "Cache" : "Semantic cache") << " hit, skipping upstream call"
+                      << std::endl;
+            s.window.append("user", userMessage);
+            s.window.append("assistant", cached);
+            maybeCompact(s);
+            return cached;
+        }
         
-        curl = curl_easy_init();
-        if (curl) {
-            // Build messages array JSON
-            std::ostringstream messagesJson;
-            messagesJson << "[";
-            
-            // Only include last 10 messages to avoid token limits
-            size_t startIdx = 0;
-            if (conversationHistory.size() > 11) {
-                startIdx = conversationHistory.size() - 11;
-                // Always include system prompt (index 0)
-                messagesJson << "{\"role\":\"" << conversationHistory[0].first 
-                             << "\",\"content\":\"" << escapeJsonString(conversationHistory[0].second) << "\"},";
-                startIdx = std::max(startIdx, (size_t)1);
-            }
-            
-            for (size_t i = (startIdx == 0 ? 0 : startIdx); i < conversationHistory.size(); i++) {
-                if (i > (startIdx == 0 ? 0 : startIdx)) messagesJson << ",";
-                messagesJson << "{\"role\":\"" << conversationHistory[i].first 
-                             << "\",\"content\":\"" << escapeJsonString(conversationHistory[i].second) << "\"}";
-            }
-            messagesJson << "]";
-            
-            // Build request body
-            std::ostringstream requestBody;
-            requestBody << "{"
-                       << "\"model\":\"" << model << "\","
-                       << "\"messages\":" << messagesJson.str()
-                       << "}";
-            
-            std::string bodyStr = requestBody.str();
-            
-            // Set up headers
-            struct curl_slist* headers = nullptr;
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            std::string authHeader = "Authorization: Bearer " + apiKey;
-            headers = curl_slist_append(headers, authHeader.c_str());
-            
-            curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, bodyStr.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-            
-            // Debug logging
-            std::cerr << "[Groq] Sending request to: " << baseUrl << std::endl;
-            std::cerr << "[Groq] Model: " << model << std::endl;
-            
-            res = curl_easy_perform(curl);
-            
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
+        // Add user message to history; older turns fall out once over budget
+        s.window.append("user", userMessage);
+        
+        HttpRequest req;
+        req.method = "POST";
+        req.url = baseUrl;
+        req.body = buildRequestBody(s);
+        req.headers.push_back("Content-Type: application/json");
+        req.headers.push_back("Authorization: Bearer " + apiKey);
+        req.timeoutMs = 30000;
+        
+        // Debug logging
+        std::cerr << "[Groq] Sending request to: " << baseUrl << std::endl;
+        std::cerr << "[Groq] Model: " << model << ", context: " << s.window.size()
+                  << " turns, ~" << s.window.tokens() << " tokens" << std::endl;
+        
+        // The transfer itself runs on the shared I/O event loop; identical
+        // in-flight prompts wait on the same upstream call, each only until
+        // its own deadline
+        HttpResult timedOut;
+        timedOut.curlCode = CURLE_OPERATION_TIMEDOUT;
+        HttpResult result = upstreamFlight().run(ResponseCache::hashKey(req.body), [&]() {
+            return callUpstream(req, deadline);
+        }, deadline, timedOut);
+        
+        if (!result.ok()) {
+            std::cerr << "[Groq] CURL error: " << result.error() << std::endl;
+            // Remove the user message we added since request failed
+            s.window.popBack();
+            return "";
+        }
+        
+        const std::string& readBuffer = result.body;
+        
+        // Debug: log raw response
+        std::cerr << "[Groq] Response: " << readBuffer << std::endl;
+        
+        // Parse JSON response
+        try {
+            json responseJson = json::parse(readBuffer);
             
-            if (res != CURLE_OK) {
-                std::cerr << "[Groq] CURL error: " << curl_easy_strerror(res) << std::endl;
-                // Remove the user message we added since request failed
-                conversationHistory.pop_back();
+            // Check for error
+            if (responseJson.contains("error")) {
+                std::string errorMsg = responseJson["error"]["message"].get<std::string>();
+                std::cerr << "[Groq] API Error: " << errorMsg << std::endl;
+                s.window.popBack();
                 return "";
             }
             
-            // Debug: log raw response
-            std::cerr << "[Groq] Response: " << readBuffer << std::endl;
-            
-            // Parse JSON response
-            try {
-                json responseJson = json::parse(readBuffer);
+            // Extract assistant response
+            if (responseJson.contains("choices") && !responseJson["choices"].empty()) {
+                std::string assistantResponse = responseJson["choices"][0]["message"]["content"].get<std::string>();
                 
-                // Check for error
-                if (responseJson.contains("error")) {
-                    std::string errorMsg = responseJson["error"]["message"].get<std::string>();
-                    std::cerr << "[Groq] API Error: " << errorMsg << std::endl;
-                    conversationHistory.pop_back();
-                    return "";
-                }
+                // Add assistant response to history
+                s.window.append("assistant", assistantResponse);
+                cache.put(cacheKey, assistantResponse, result.elapsedMs);
+                semanticCache.put(contextId, userMessage, assistantResponse, result.elapsedMs);
+                maybeCompact(s);
                 
-                // Extract assistant response
-                if (responseJson.contains("choices") && !responseJson["choices"].empty()) {
-                    std::string assistantResponse = responseJson["choices"][0]["message"]["content"].get<std::string>();
-                    
-                    // Add assistant response to history
-                    conversationHistory.push_back({"assistant", assistantResponse});
-                    
-                    return assistantResponse;
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "[Groq] JSON parse error: " << e.what() << std::endl;
-                conversationHistory.pop_back();
-                return "";
+                return assistantResponse;
             }
+        } catch (const std::exception& e) {
+            std::cerr << "[Groq] JSON parse error: " << e.what() << std::endl;
+            s.window.popBack();
+            return "";
         }
         
-        conversationHistory.pop_back();
+        s.window.popBack();
         return "";
     }
     
+    static SingleFlight<HttpResult>& upstreamFlight() {
+        static SingleFlight<HttpResult> flight;
+        return flight;
+    }
+    
+    void configureCache(size_t maxEntries, int ttlSeconds) {
+        cache.configure(maxEntries, ttlSeconds);
+    }
+    
+    // Drops every semantic entry
+    void configureSemanticCache(const SemanticCache::Options& options) {
+        semanticCache.configure(options);
+    }
+    
+    // Applies to live sessions as well as new ones
+    void setContextTokenBudget(size_t tokens) {
+        tokenBudget = tokens;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            for (auto& entry : shard.sessions) {
+                std::lock_guard<std::mutex> sessionLock(entry.second->mtx);
+                entry.second->window.setTokenBudget(tokens);
+            }
+        }
+    }
+    
+    void setCompactionThreshold(size_t tokens) {
+        compactThreshold = tokens;
+    }
+    
+    void setHedging(bool enabled) {
+        hedging = enabled;
+    }
+    
+    HedgeStats getHedgeStats() const {
+        HedgeStats stats;
+        stats.hedged = upstream->hedged;
+        stats.hedgeWins = upstream->hedgeWins;
+        stats.deadlineExceeded = upstream->deadlineExceeded;
+        stats.p95Ms = upstream->latency.percentile(0.95);
+        return stats;
+    }
+    
+    size_t getSessionCount() {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            total += shard.sessions.size();
+        }
+        return total;
+    }
+    
+    ResponseCache::Stats getCacheStats() const {
+        return cache.getStats();
+    }
+    
+    SemanticCache::Stats getSemanticCacheStats() const {
+        return semanticCache.getStats();
+    }
+    
     bool isAvailable() const {
         return !apiKey.empty();
     }
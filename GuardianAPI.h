@@ -7,15 +7,13 @@
 #include <iostream>
 #include <sstream>
 #include "config.h"
+#include "NewsParser.h"
+#include "AsyncHttp.h"
+#include "SingleFlight.h"
 
 
 class GuardianAPI {
 private:
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-        ((std::string*)userp)->append((char*)contents, size * nmemb);
-        return size * nmemb;
-    }
-
     static std::string urlEncode(const std::string& str) {
         std::string encoded = str;
         size_t pos = 0;
@@ -35,83 +33,55 @@ public:
         std::string description;
     };
 
-    static std::string fetchNews(const std::string& keyword = "", int pageSize = 5) {
-        CURL* curl;
-        CURLcode res;
-        std::string readBuffer;
+    // Concurrent fetches for the same keyword share one upstream request
+    static SingleFlight<std::string>& fetchFlight() {
+        static SingleFlight<std::string> flight;
+        return flight;
+    }
 
-        curl = curl_easy_init();
-        if (curl) {
-            std::string url = "https://content.guardianapis.com/search?";
-            url += "api-key=a0b5386d-4cd2-48b4-a86f-356a336f112e";
-            url += "&show-fields=headline,trailText";
-            url += "&page-size=" + std::to_string(pageSize);
-            url += "&order-by=newest";
+    // section filters by Guardian section id ("world", "sport", ...)
+    static std::string fetchNews(const std::string& keyword = "", int pageSize = 5, const std::string& section = "") {
+        std::string flightKey = keyword + "|" + section + "|" + std::to_string(pageSize);
+        return fetchFlight().run(flightKey, [&]() {
+            HttpRequest req;
+            req.url = "https://content.guardianapis.com/search?";
+            req.url += "api-key=a0b5386d-4cd2-48b4-a86f-356a336f112e";
+            req.url += "&show-fields=headline,trailText";
+            req.url += "&page-size=" + std::to_string(pageSize);
+            req.url += "&order-by=newest";
 
             if (!keyword.empty()) {
-                url += "&q=" + urlEncode(keyword);
+                req.url += "&q=" + urlEncode(keyword);
             }
+            if (!section.empty()) {
+                req.url += "&section=" + urlEncode(section);
+            }
+            req.timeoutMs = 10000;
 
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-
-            res = curl_easy_perform(curl);
-            curl_easy_cleanup(curl);
-
-            if (res != CURLE_OK) {
-                return "{\"error\": \"Failed to fetch news\"}";
+            HttpResult result = AsyncHttp::shared().perform(req);
+            if (!result.ok()) {
+                return std::string("{\"error\": \"Failed to fetch news\"}");
             }
-        }
 
-        return readBuffer;
+            return result.body;
+        });
     }
 
-    static std::vector<NewsArticle> parseNews(const std::string& jsonResponse) {
-        std::vector<NewsArticle> articles;
+    // Single-pass structural parse of response.results (shared with NewsManager)
+    static std::vector<NewsArticle> parseNews(const std::string& jsonResponse, size_t limit = 5) {
+        std::vector<NewsParser::ArticleRef> refs;
+        NewsParser::parse(jsonResponse, refs, limit);
 
-        // Simple JSON parsing without external library
-        size_t pos = 0;
-        while ((pos = jsonResponse.find("\"webTitle\":\"", pos)) != std::string::npos) {
+        std::vector<NewsArticle> articles;
+        articles.reserve(refs.size());
+        for (const auto& ref : refs) {
             NewsArticle article;
-
-            // Extract title
-            pos += 12;
-            size_t endPos = jsonResponse.find("\"", pos);
-            if (endPos != std::string::npos) {
-                article.title = jsonResponse.substr(pos, endPos - pos);
-            }
-
-            // Extract URL
-            size_t urlPos = jsonResponse.find("\"webUrl\":\"", pos);
-            if (urlPos != std::string::npos) {
-                urlPos += 10;
-                size_t urlEnd = jsonResponse.find("\"", urlPos);
-                article.url = jsonResponse.substr(urlPos, urlEnd - urlPos);
-            }
-
-            // Extract section
-            size_t secPos = jsonResponse.find("\"sectionName\":\"", pos);
-            if (secPos != std::string::npos) {
-                secPos += 15;
-                size_t secEnd = jsonResponse.find("\"", secPos);
-                article.section = jsonResponse.substr(secPos, secEnd - secPos);
-            }
-
-            // Extract date
-            size_t datePos = jsonResponse.find("\"webPublicationDate\":\"", pos);
-            if (datePos != std::string::npos) {
-                datePos += 22;
-                size_t dateEnd = jsonResponse.find("\"", datePos);
-                article.date = jsonResponse.substr(datePos, dateEnd - datePos);
-            }
-
+            article.title = NewsParser::value(jsonResponse, ref.title);
+            article.url = NewsParser::value(jsonResponse, ref.url);
+            article.section = NewsParser::value(jsonResponse, ref.section);
+            article.date = NewsParser::value(jsonResponse, ref.date);
+            article.description = NewsParser::value(jsonResponse, ref.trailText);
             articles.push_back(article);
-            pos = endPos;
-
-            if (articles.size() >= 5) break;
         }
 
         return articles;
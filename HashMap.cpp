@@ -4,9 +4,9 @@
 #include <functional>
 
 // ResponseMap Implementation
-ResponseMap::ResponseMap() : size(0), capacity(TABLE_SIZE) {
-    table = new HashNode*[TABLE_SIZE];
-    for (int i = 0; i < TABLE_SIZE; i++) {
+ResponseMap::ResponseMap(int buckets) : size(0), capacity(std::max(buckets, 1)) {
+    table = new HashNode*[capacity];
+    for (int i = 0; i < capacity; i++) {
         table[i] = nullptr;
     }
 }
@@ -18,7 +18,7 @@ ResponseMap::~ResponseMap() {
 
 int ResponseMap::hashFunction(const std::string& key) const {
     std::hash<std::string> hasher;
-    return hasher(key) % TABLE_SIZE;
+    return hasher(key) % capacity;
 }
 
 HashNode* ResponseMap::findNode(const std::string& key) const {
@@ -116,7 +116,7 @@ bool ResponseMap::isEmpty() const {
 }
 
 void ResponseMap::clear() {
-    for (int i = 0; i < TABLE_SIZE; i++) {
+    for (int i = 0; i < capacity; i++) {
         HashNode* current = table[i];
         while (current != nullptr) {
             HashNode* temp = current;
@@ -130,8 +130,9 @@ void ResponseMap::clear() {
 
 std::vector<std::string> ResponseMap::getAllKeys() const {
     std::vector<std::string> keys;
+    keys.reserve(size);
     
-    for (int i = 0; i < TABLE_SIZE; i++) {
+    for (int i = 0; i < capacity; i++) {
         HashNode* current = table[i];
         while (current != nullptr) {
             keys.push_back(current->key);
@@ -144,7 +145,7 @@ std::vector<std::string> ResponseMap::getAllKeys() const {
 
 void ResponseMap::display() const {
     std::cout << "\n========== Response Map ==========\n";
-    for (int i = 0; i < TABLE_SIZE; i++) {
+    for (int i = 0; i < capacity; i++) {
         HashNode* current = table[i];
         while (current != nullptr) {
             std::cout << "Key: " << current->key << " -> ";
@@ -159,6 +160,6 @@ void ResponseMap::display() const {
 }
 
 double ResponseMap::getLoadFactor() const {
-    return static_cast<double>(size) / TABLE_SIZE;
+    return static_cast<double>(size) / capacity;
 }
 
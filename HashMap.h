@@ -32,8 +32,10 @@ private:
     HashNode* findNode(const std::string& key) const;
     
 public:
-    ResponseMap();
+    explicit ResponseMap(int buckets = TABLE_SIZE);
     ~ResponseMap();
+    ResponseMap(const ResponseMap&) = delete;
+    ResponseMap& operator=(const ResponseMap&) = delete;
     
     // Insert operation
     void insert(const std::string& key, const std::string& value);
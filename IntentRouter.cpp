@@ -0,0 +1,117 @@
+#include "IntentRouter.h"
+#include <algorithm>
+#include <iostream>
+
+void IntentRouter::addIntent(const std::string& name, int priority, const std::vector<std::string>& keywords,
+                             const std::vector<std::string>& phrases, Handler handler) {
+    if ((int)intents.size() >= kMaxIntents) {
+        std::cerr << "[IntentRouter] Too many intents, ignoring " << name << std::endl;
+        return;
+    }
+    std::unique_ptr<Intent> intent(new Intent());
+    intent->name = name;
+    intent->priority = priority;
+    intent->handler = handler;
+    // Rules are split like the input, so "What's new?" and "what s new" agree
+    Tokenizer tokenizer;
+    for (const auto* rules : {&keywords, &phrases}) {
+        for (const auto& rule : *rules) {
+            tokenizer.tokenize(rule);
+            std::vector<std::string> words;
+            for (const TokenView& token : tokenizer.tokens()) {
+                words.push_back(token.str());
+            }
+            if (!words.empty()) intent->triggers.push_back(words);
+        }
+    }
+    intents.push_back(std::move(intent));
+}
+
+void IntentRouter::compile() {
+    table.clear();
+    byPriority.clear();
+    alwaysMask = 0;
+    for (uint32_t id = 0; id < intents.size(); id++) {
+        const Intent& intent = *intents[id];
+        if (intent.triggers.empty()) alwaysMask |= 1u << id;
+        for (const auto& words : intent.triggers) {
+            Trigger trigger;
+            trigger.intent = id;
+            trigger.phrase = &words;
+            table[words[0]].push_back(trigger);
+        }
+        byPriority.push_back(id);
+    }
+    // Ties keep registration order
+    std::stable_sort(byPriority.begin(), byPriority.end(), [this](uint32_t a, uint32_t b) {
+        return intents[a]->priority > intents[b]->priority;
+    });
+}
+
+// One pass over the words: each looks up the triggers starting with it,
+// and a phrase checks the words that follow
+uint32_t IntentRouter::match(const Tokenizer& tokens) const {
+    static thread_local std::string word;
+    const std::vector<TokenView>& words = tokens.tokens();
+    uint32_t mask = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        word.assign(words[i].data, words[i].size);
+        auto it = table.find(word);
+        if (it == table.end()) continue;
+        for (const Trigger& trigger : it->second) {
+            const std::vector<std::string>& phrase = *trigger.phrase;
+            if (i + phrase.size() > words.size()) continue;
+            bool matched = true;
+            for (size_t k = 1; k < phrase.size() && matched; k++) {
+                matched = words[i + k] == phrase[k].c_str();
+            }
+            if (matched) mask |= 1u << trigger.intent;
+        }
+    }
+    return mask;
+}
+
+const std::string& IntentRouter::dispatch(const Request& request, std::string& response) {
+    static const std::string none;
+    typedef std::chrono::steady_clock Clock;
+    auto start = Clock::now();
+    uint32_t triggered = match(request.tokens);
+    routeLatency.record(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+    for (uint32_t id = 0; id < intents.size(); id++) {
+        if (triggered & (1u << id)) intents[id]->triggered++;
+    }
+
+    uint32_t candidates = triggered | alwaysMask;
+    for (uint32_t id : byPriority) {
+        if (!(candidates & (1u << id))) continue;
+        Intent& intent = *intents[id];
+        auto handlerStart = Clock::now();
+        bool answered = intent.handler(request, response);
+        intent.latency.record(std::chrono::duration<double, std::milli>(Clock::now() - handlerStart).count());
+        if (answered) {
+            intent.handled++;
+            return intent.name;
+        }
+        intent.declined++;
+        response.clear();
+    }
+    return none;
+}
+
+IntentRouter::Stats IntentRouter::getStats() const {
+    Stats stats;
+    stats.routeP50Us = routeLatency.percentile(0.5) * 1000.0;
+    stats.routeP95Us = routeLatency.percentile(0.95) * 1000.0;
+    for (const auto& intent : intents) {
+        IntentStats s;
+        s.name = intent->name;
+        s.triggered = intent->triggered.load();
+        s.handled = intent->handled.load();
+        s.declined = intent->declined.load();
+        s.p50Ms = intent->latency.percentile(0.5);
+        s.p95Ms = intent->latency.percentile(0.95);
+        stats.intents.push_back(s);
+    }
+    return stats;
+}
@@ -0,0 +1,90 @@
+#ifndef INTENTROUTER_H
+#define INTENTROUTER_H
+
+#include "Tokenizer.h"
+#include "LatencyTracker.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+// Decides which handler answers a message. Each intent has keywords and
+// phrases that trigger it (none = tried for every message) and a priority.
+// compile() turns the rules into one table keyed by word, so a single pass
+// over the tokens finds every triggered intent. Their handlers then run
+// highest priority first until one answers. Rules are fixed after
+// compile(); routing takes no lock.
+class IntentRouter {
+public:
+    struct Request {
+        const std::string& text;            // as the user typed it
+        const Tokenizer& tokens;
+        const std::string& userId;
+        bool allowAI;
+        bool allowCache;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    // Returns false to pass the message on to the next intent
+    typedef std::function<bool(const Request& request, std::string& response)> Handler;
+
+    struct IntentStats {
+        std::string name;
+        long long triggered;    // a keyword or phrase matched
+        long long handled;      // answered
+        long long declined;     // passed on
+        double p50Ms;           // handler time, answered or not
+        double p95Ms;
+    };
+
+    static const int kMaxIntents = 32;
+
+    IntentRouter() : alwaysMask(0) {}
+
+    void addIntent(const std::string& name, int priority, const std::vector<std::string>& keywords,
+                   const std::vector<std::string>& phrases, Handler handler);
+    void compile();
+
+    // Name of the intent that answered, or "" if every handler declined
+    const std::string& dispatch(const Request& request, std::string& response);
+
+    struct Stats {
+        double routeP50Us;      // time to find the triggered intents
+        double routeP95Us;
+        std::vector<IntentStats> intents;   // in registration order
+    };
+
+    Stats getStats() const;
+
+private:
+    struct Intent {
+        std::string name;
+        int priority;
+        std::vector<std::vector<std::string>> triggers;   // tokenized keywords and phrases
+        Handler handler;
+        std::atomic<long long> triggered;
+        std::atomic<long long> handled;
+        std::atomic<long long> declined;
+        LatencyTracker latency;
+        Intent() : priority(0), triggered(0), handled(0), declined(0) {}
+    };
+
+    // A keyword, or the first word of a phrase whose rest must follow
+    struct Trigger {
+        uint32_t intent;
+        const std::vector<std::string>* phrase;
+    };
+
+    std::vector<std::unique_ptr<Intent>> intents;
+    std::vector<uint32_t> byPriority;                           // intent ids, highest first
+    std::unordered_map<std::string, std::vector<Trigger>> table;   // first word -> triggers
+    uint32_t alwaysMask;
+    LatencyTracker routeLatency;
+
+    uint32_t match(const Tokenizer& tokens) const;
+};
+
+#endif // INTENTROUTER_H
@@ -0,0 +1,30 @@
+#include "LatencyTracker.h"
+#include <algorithm>
+
+LatencyTracker::LatencyTracker(size_t window)
+    : samples(window > 0 ? window : 1, 0.0), next(0), count(0) {}
+
+void LatencyTracker::record(double ms) {
+    std::lock_guard<std::mutex> lock(mtx);
+    samples[next] = ms;
+    next = (next + 1) % samples.size();
+    if (count < samples.size()) count++;
+}
+
+double LatencyTracker::percentile(double p) const {
+    std::vector<double> window;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (count == 0) return 0.0;
+        window.assign(samples.begin(), samples.begin() + count);
+    }
+    p = std::max(0.0, std::min(1.0, p));
+    size_t rank = (size_t)(p * (window.size() - 1) + 0.5);
+    std::nth_element(window.begin(), window.begin() + rank, window.end());
+    return window[rank];
+}
+
+size_t LatencyTracker::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
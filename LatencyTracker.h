@@ -0,0 +1,27 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+// Rolling window of the most recent latency samples.
+// Used to derive hedging delays from observed upstream percentiles.
+class LatencyTracker {
+private:
+    mutable std::mutex mtx;
+    std::vector<double> samples;   // ring buffer
+    size_t next;
+    size_t count;
+
+public:
+    explicit LatencyTracker(size_t window = 256);
+
+    void record(double ms);
+
+    // p in [0, 1]; returns 0 while there are no samples
+    double percentile(double p) const;
+    size_t size() const;
+};
+
+#endif // LATENCYTRACKER_H
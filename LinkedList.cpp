@@ -1,9 +1,10 @@
 #include "LinkedList.h"
+#include "Tokenizer.h"
 #include <iostream>
 #include <iomanip>
 
 // ConversationHistory Implementation
-ConversationHistory::ConversationHistory() : head(nullptr), tail(nullptr), size(0) {}
+ConversationHistory::ConversationHistory(int maxSize) : head(nullptr), tail(nullptr), size(0), maxSize(maxSize) {}
 
 ConversationHistory::~ConversationHistory() {
     clear();
@@ -19,6 +20,20 @@ void ConversationHistory::insertAtEnd(const Message& msg) {
         tail = newNode;
     }
     size++;
+    
+    // Every message is already persisted, so the in-memory copy only keeps the recent tail
+    if (maxSize > 0 && size > maxSize) {
+        removeFirst();
+    }
+}
+
+void ConversationHistory::removeFirst() {
+    if (isEmpty()) return;
+    MessageNode* temp = head;
+    head = head->next;
+    if (head == nullptr) tail = nullptr;
+    delete temp;
+    size--;
 }
 
 void ConversationHistory::insertAtBeginning(const Message& msg) {
@@ -112,11 +127,12 @@ Message ConversationHistory::getLastMessage() const {
 MessageNode* ConversationHistory::searchByContent(const std::string& keyword) const {
     MessageNode* current = head;
     std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    Tokenizer::fold(lowerKeyword);
     
+    std::string content;  // one buffer, refilled for each message
     while (current != nullptr) {
-        std::string content = current->data.content;
-        std::transform(content.begin(), content.end(), content.begin(), ::tolower);
+        content.assign(current->data.content);
+        Tokenizer::fold(content);
         
         if (content.find(lowerKeyword) != std::string::npos) {
             return current;
@@ -126,6 +142,15 @@ MessageNode* ConversationHistory::searchByContent(const std::string& keyword) co
     return nullptr;
 }
 
+std::vector<Message> ConversationHistory::getAllMessages() const {
+    std::vector<Message> messages;
+    messages.reserve(size);
+    for (MessageNode* current = head; current != nullptr; current = current->next) {
+        messages.push_back(current->data);
+    }
+    return messages;
+}
+
 std::vector<Message> ConversationHistory::getMessagesBySender(const std::string& sender) const {
     std::vector<Message> messages;
     MessageNode* current = head;
@@ -23,9 +23,12 @@ private:
     MessageNode* head;
     MessageNode* tail;
     int size;
+    int maxSize;    // oldest messages are dropped past this (0 = unbounded)
+    
+    void removeFirst();
     
 public:
-    ConversationHistory();
+    ConversationHistory(int maxSize = 0);
     ~ConversationHistory();
     
     // Insert operations
@@ -45,6 +48,7 @@ public:
     // Search operations
     MessageNode* searchByContent(const std::string& keyword) const;
     std::vector<Message> getMessagesBySender(const std::string& sender) const;
+    std::vector<Message> getAllMessages() const;
 };
 
 #endif // LINKEDLIST_H
@@ -0,0 +1,476 @@
+#include "MessageLog.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <future>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// ========== ENCODING ==========
+
+// Frame: u32 payload length, u32 crc32(payload), payload
+// Payload: u64 lsn, then userId, content, sender, timestamp as u32-length strings
+static const size_t kFrameHeader = 8;
+static const uint32_t kMaxPayload = 64u << 20;
+
+static void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out += (char)((v >> (8 * i)) & 0xFF);
+}
+
+static void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out += (char)((v >> (8 * i)) & 0xFF);
+}
+
+static void putString(std::string& out, const std::string& s) {
+    putU32(out, (uint32_t)s.size());
+    out += s;
+}
+
+static uint32_t getU32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t getU64(const char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+static bool getString(const char*& p, const char* end, std::string& out) {
+    if (end - p < 4) return false;
+    uint32_t n = getU32(p);
+    p += 4;
+    if ((size_t)(end - p) < n) return false;
+    out.assign(p, n);
+    p += n;
+    return true;
+}
+
+static void encodeRecord(std::string& out, uint64_t lsn, const std::string& userId, const Message& msg) {
+    std::string payload;
+    payload.reserve(8 + 16 + userId.size() + msg.content.size() + msg.sender.size() + msg.timestamp.size());
+    putU64(payload, lsn);
+    putString(payload, userId);
+    putString(payload, msg.content);
+    putString(payload, msg.sender);
+    putString(payload, msg.timestamp);
+
+    putU32(out, (uint32_t)payload.size());
+    putU32(out, MessageLog::crc32(payload.data(), payload.size()));
+    out += payload;
+}
+
+static bool decodeRecord(const char* p, size_t length, MessageLog::Record& rec) {
+    const char* end = p + length;
+    if (length < 8) return false;
+    rec.lsn = getU64(p);
+    p += 8;
+    return getString(p, end, rec.userId) && getString(p, end, rec.message.content) &&
+           getString(p, end, rec.message.sender) && getString(p, end, rec.message.timestamp) && p == end;
+}
+
+uint32_t MessageLog::crc32(const char* data, size_t length) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        ready = true;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+const char* const MessageLog::kClearSender = "clear";
+
+// ========== LIFECYCLE ==========
+
+MessageLog::MessageLog(const Options& opts)
+    : options(opts), bufferFirstLsn(0), commit(std::make_shared<Commit>()), lastLsn(0), durableLsn(0), fd(-1),
+      segmentSize(0), rotate(false),
+      fsyncs(0), recordsAppended(0), writeErrors(0), replicatedLsn(0), retainedLsn(UINT64_MAX),
+      rejectedRecords(0), stopping(false) {
+    crc32("", 0);  // build the table before any concurrent use
+}
+
+MessageLog::~MessageLog() {
+    stop();
+}
+
+std::string MessageLog::segmentPath(uint64_t firstLsn) const {
+    char name[40];
+    snprintf(name, sizeof(name), "wal-%020llu.log", (unsigned long long)firstLsn);
+    return options.directory + "/" + name;
+}
+
+std::string MessageLog::checkpointPath() const {
+    return options.directory + "/replicated";
+}
+
+std::string MessageLog::quarantinePath() const {
+    return options.directory + "/rejected.log";
+}
+
+bool MessageLog::open(const std::function<void(const Record&)>& onReplay, uint64_t replayAfter) {
+    mkdir(options.directory.c_str(), 0755);
+    DIR* dir = opendir(options.directory.c_str());
+    if (!dir) {
+        std::cerr << "[WAL] Cannot open directory " << options.directory << std::endl;
+        return false;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        unsigned long long first = 0;
+        if (sscanf(entry->d_name, "wal-%20llu.log", &first) == 1) {
+            segments.push_back({(uint64_t)first, options.directory + "/" + entry->d_name});
+        }
+    }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment& a, const Segment& b) { return a.firstLsn < b.firstLsn; });
+
+    std::ifstream checkpoint(checkpointPath());
+    unsigned long long replicated = 0;
+    if (checkpoint >> replicated) {
+        replicatedLsn = replicated;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t replayed = 0;
+    for (const auto& segment : segments) {
+        replayed += replaySegment(segment, [&](const Record& rec) {
+            lastLsn = std::max(lastLsn, rec.lsn);
+            if (rec.lsn > replicatedLsn) replQueue.push_back(rec);
+            if (onReplay && rec.lsn > replayAfter) onReplay(rec);
+        });
+    }
+    lastLsn = std::max(lastLsn, replicatedLsn);
+    durableLsn = lastLsn;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[WAL] Replayed " << replayed << " records from " << segments.size() << " segments in "
+              << ms << " ms (" << replQueue.size() << " awaiting replication)" << std::endl;
+
+    // New appends always go to a fresh segment, never after a repaired tail
+    if (!openSegment(lastLsn + 1)) {
+        return false;
+    }
+    flusher = std::thread(&MessageLog::flushLoop, this);
+    return true;
+}
+
+size_t MessageLog::replaySegment(const Segment& segment, const std::function<void(const Record&)>& onRecord) {
+    std::ifstream in(segment.path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    size_t count = 0;
+    while (data.size() - pos >= kFrameHeader) {
+        uint32_t length = getU32(data.data() + pos);
+        uint32_t crc = getU32(data.data() + pos + 4);
+        if (length > kMaxPayload || data.size() - pos - kFrameHeader < length) break;
+        const char* payload = data.data() + pos + kFrameHeader;
+        Record rec;
+        if (crc32(payload, length) != crc || !decodeRecord(payload, length, rec)) break;
+        onRecord(rec);
+        count++;
+        pos += kFrameHeader + length;
+    }
+
+    if (pos < data.size()) {
+        // Torn write from a crash (or corruption): keep the intact prefix only
+        std::cerr << "[WAL] " << segment.path << ": dropping " << data.size() - pos
+                  << " bytes after the last valid record" << std::endl;
+        if (truncate(segment.path.c_str(), (off_t)pos) != 0) {
+            std::cerr << "[WAL] Failed to truncate " << segment.path << std::endl;
+        }
+    }
+    return count;
+}
+
+bool MessageLog::openSegment(uint64_t firstLsn) {
+    if (fd >= 0) {
+        close(fd);
+    }
+    std::string path = segmentPath(firstLsn);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        std::cerr << "[WAL] Cannot open segment " << path << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (segments.empty() || segments.back().path != path) {
+            segments.push_back({firstLsn, path});
+        }
+    }
+    segmentSize = 0;
+
+    // Make the new directory entry itself durable
+    int dirFd = ::open(options.directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+
+void MessageLog::stop() {
+    if (stopping.exchange(true)) return;
+    flushCv.notify_all();
+    replCv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    if (replicator.joinable()) replicator.join();
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// ========== WRITE PATH ==========
+
+uint64_t MessageLog::append(const std::string& userId, const std::vector<Message>& messages) {
+    if (messages.empty()) return 0;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    if (buffer.empty()) bufferFirstLsn = lastLsn + 1;
+    for (const auto& msg : messages) {
+        Record rec;
+        rec.lsn = ++lastLsn;
+        rec.userId = userId;
+        rec.message = msg;
+        encodeRecord(buffer, rec.lsn, userId, msg);
+        commit->records.push_back(std::move(rec));
+    }
+    uint64_t last = lastLsn;
+    std::shared_ptr<Commit> joined = commit;
+    recordsAppended += (long long)messages.size();
+    flushCv.notify_one();
+
+    // Group commit: one fdatasync covers everyone who appended meanwhile
+    durableCv.wait(lock, [&]() { return joined->done || stopping; });
+    return joined->ok ? last : 0;
+}
+
+uint64_t MessageLog::appendClear(const std::string& userId) {
+    return append(userId, {Message("", kClearSender, "")});
+}
+
+void MessageLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        flushCv.wait(lock, [&]() { return stopping || !buffer.empty(); });
+        if (buffer.empty()) break;  // stopping with nothing left to write
+
+        // Give concurrent appenders a moment to join this batch
+        if (options.groupCommitMs > 0 && !stopping) {
+            flushCv.wait_for(lock, std::chrono::milliseconds(options.groupCommitMs),
+                             [&]() { return (bool)stopping; });
+        }
+
+        std::string batch;
+        batch.swap(buffer);
+        std::shared_ptr<Commit> written = commit;
+        commit = std::make_shared<Commit>();
+        uint64_t first = bufferFirstLsn;
+        uint64_t upTo = lastLsn;
+        lock.unlock();
+
+        bool ok = writeBatch(batch, first);
+
+        lock.lock();
+        // A failed batch is never acknowledged; its LSNs stay unused.
+        // Batches are queued for replication here, one at a time, so the
+        // queue stays in LSN order and the checkpoint never skips a record
+        if (ok) {
+            durableLsn = upTo;
+            std::lock_guard<std::mutex> replLock(replMtx);
+            for (auto& rec : written->records) replQueue.push_back(std::move(rec));
+            replCv.notify_one();
+        }
+        written->records.clear();
+        written->ok = ok;
+        written->done = true;
+        durableCv.notify_all();
+    }
+}
+
+bool MessageLog::writeBatch(const std::string& batch, uint64_t firstLsn) {
+    if (segmentSize >= options.segmentBytes || rotate || fd < 0) {
+        rotate = !openSegment(firstLsn);
+    }
+
+    const char* p = batch.data();
+    size_t left = batch.size();
+    while (left > 0 && fd >= 0) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    bool ok = left == 0 && fd >= 0 && fdatasync(fd) == 0;
+    int error = errno;
+
+    // Cut off whatever part of the batch reached the file, so later batches
+    // never follow a torn frame; failing that, they go to a new segment
+    if (!ok && fd >= 0 && (ftruncate(fd, (off_t)segmentSize) != 0 || fdatasync(fd) != 0)) {
+        rotate = true;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (ok) segmentSize += batch.size();
+    fsyncs++;
+    if (!ok) {
+        writeErrors++;
+        std::cerr << "[WAL] Write failed: " << strerror(error) << std::endl;
+    }
+    return ok;
+}
+
+// ========== REPLICATION ==========
+
+void MessageLog::startReplication(Shipper ship) {
+    shipper = ship;
+    replicator = std::thread(&MessageLog::replicateLoop, this);
+}
+
+void MessageLog::replicateLoop() {
+    int failures = 0;
+    while (!stopping) {
+        std::vector<Record> batch;
+        {
+            std::unique_lock<std::mutex> lock(replMtx);
+            replCv.wait(lock, [&]() { return stopping || !replQueue.empty(); });
+            if (stopping) break;
+            // One user per batch so it maps onto a single upstream write; a
+            // clear marker ships alone, after everything logged before it
+            const Record& front = replQueue.front();
+            if (front.isClear()) {
+                batch.push_back(front);
+            } else {
+                for (auto it = replQueue.begin(); it != replQueue.end() && it->userId == front.userId &&
+                                                  !it->isClear() && batch.size() < 64; ++it) {
+                    batch.push_back(*it);
+                }
+            }
+        }
+
+        auto shipped = std::make_shared<std::promise<ShipResult>>();
+        auto once = std::make_shared<std::once_flag>();
+        std::future<ShipResult> result = shipped->get_future();
+        shipper(batch, [shipped, once](ShipResult outcome) {
+            std::call_once(*once, [&]() { shipped->set_value(outcome); });
+        });
+        ShipResult outcome = result.wait_for(std::chrono::seconds(30)) == std::future_status::ready ? result.get() : RETRY;
+
+        // A batch the upstream refuses for good is set aside, not retried,
+        // so it cannot hold up every other user's replication
+        if (outcome == REJECTED) quarantine(batch);
+
+        if (outcome != RETRY) {
+            failures = 0;
+            uint64_t upTo = batch.back().lsn;
+            {
+                std::lock_guard<std::mutex> lock(replMtx);
+                for (size_t i = 0; i < batch.size(); i++) replQueue.pop_front();
+                replicatedLsn = std::max(replicatedLsn, upTo);
+            }
+            saveCheckpoint(upTo);
+            dropReplicatedSegments();
+        } else {
+            // Upstream is down; the records are safe on disk, retry later
+            failures = std::min(failures + 1, 6);
+            std::unique_lock<std::mutex> lock(replMtx);
+            replCv.wait_for(lock, std::chrono::milliseconds(500LL << failures), [&]() { return (bool)stopping; });
+        }
+    }
+}
+
+// Rejected records are kept in the log's own frame format for inspection
+void MessageLog::quarantine(const std::vector<Record>& batch) {
+    std::string frames;
+    for (const auto& rec : batch) encodeRecord(frames, rec.lsn, rec.userId, rec.message);
+    std::ofstream out(quarantinePath(), std::ios::binary | std::ios::app);
+    out.write(frames.data(), (std::streamsize)frames.size());
+    {
+        std::lock_guard<std::mutex> lock(replMtx);
+        rejectedRecords += (long long)batch.size();
+    }
+    std::cerr << "[WAL] Upstream rejected LSN " << batch.front().lsn << "-" << batch.back().lsn << " for "
+              << batch.front().userId << ", moved to " << quarantinePath() << std::endl;
+}
+
+void MessageLog::saveCheckpoint(uint64_t lsn) {
+    std::string tmp = checkpointPath() + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << (unsigned long long)lsn << "\n";
+    }
+    std::rename(tmp.c_str(), checkpointPath().c_str());
+}
+
+void MessageLog::dropReplicatedSegments() {
+    std::vector<std::string> obsolete;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        uint64_t replicated;
+        {
+            std::lock_guard<std::mutex> replLock(replMtx);
+            replicated = std::min(replicatedLsn, retainedLsn);
+        }
+        // A segment is done when the next one starts at or below replicated + 1;
+        // the active (last) segment is never removed
+        size_t drop = 0;
+        while (drop + 1 < segments.size() && segments[drop + 1].firstLsn <= replicated + 1) {
+            obsolete.push_back(segments[drop].path);
+            drop++;
+        }
+        segments.erase(segments.begin(), segments.begin() + drop);
+    }
+    for (const auto& path : obsolete) {
+        std::remove(path.c_str());
+    }
+}
+
+void MessageLog::retainAfter(uint64_t lsn) {
+    {
+        std::lock_guard<std::mutex> lock(replMtx);
+        retainedLsn = lsn;
+    }
+    dropReplicatedSegments();
+}
+
+MessageLog::Stats MessageLog::getStats() {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stats.lastLsn = lastLsn;
+        stats.durableLsn = durableLsn;
+        stats.segments = segments.size();
+        stats.fsyncs = fsyncs;
+        stats.records = recordsAppended;
+        stats.writeErrors = writeErrors;
+    }
+    std::lock_guard<std::mutex> lock(replMtx);
+    stats.replicatedLsn = replicatedLsn;
+    stats.backlog = replQueue.size();
+    stats.rejected = rejectedRecords;
+    return stats;
+}
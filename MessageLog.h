@@ -0,0 +1,155 @@
+#ifndef MESSAGELOG_H
+#define MESSAGELOG_H
+
+#include "Message.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// Durable write-ahead log of chat messages.
+// Records are appended to size-rotated segment files as
+// [length][crc32][payload] frames. Concurrent appenders are batched into one
+// write + fdatasync (group commit) and return once their records are on disk.
+// The log is also the replication source: durable records are shipped to
+// Firebase in order and segments are deleted once fully replicated.
+class MessageLog {
+public:
+    struct Record {
+        uint64_t lsn;               // log sequence number, 1-based, increasing (a failed write leaves a gap)
+        std::string userId;
+        Message message;
+
+        Record() : lsn(0), message("", "", "") {}
+
+        // Marks the point where the user's context was cleared; not a message
+        bool isClear() const { return message.sender == kClearSender; }
+    };
+
+    static const char* const kClearSender;
+
+    struct Options {
+        std::string directory;
+        size_t segmentBytes;        // rotate after this many bytes
+        int groupCommitMs;          // how long the flusher waits for more appenders
+
+        Options() : directory("wal"), segmentBytes(16 << 20), groupCommitMs(2) {}
+    };
+
+    struct Stats {
+        uint64_t lastLsn;
+        uint64_t durableLsn;
+        uint64_t replicatedLsn;
+        size_t segments;
+        size_t backlog;             // durable, not yet replicated
+        long long fsyncs;
+        long long records;          // appended since startup
+        long long writeErrors;
+        long long rejected;         // records the upstream refused for good (quarantined)
+
+        Stats() : lastLsn(0), durableLsn(0), replicatedLsn(0), segments(0), backlog(0),
+                  fsyncs(0), records(0), writeErrors(0), rejected(0) {}
+    };
+
+    // How a shipped batch fared; a rejected one would fail the same way again
+    enum ShipResult { SHIPPED, RETRY, REJECTED };
+
+    // Ships one batch (records of one user, in order, or a lone clear marker)
+    // and reports the outcome
+    typedef std::function<void(const std::vector<Record>&, std::function<void(ShipResult)>)> Shipper;
+
+private:
+    struct Segment {
+        uint64_t firstLsn;
+        std::string path;
+    };
+
+    // Outcome of one group commit, shared by everyone whose records are in it
+    struct Commit {
+        std::vector<Record> records;     // in LSN order
+        bool done;
+        bool ok;
+        Commit() : done(false), ok(false) {}
+    };
+
+    Options options;
+
+    // Write path
+    std::mutex mtx;
+    std::condition_variable flushCv;     // wakes the flusher
+    std::condition_variable durableCv;   // wakes waiting appenders
+    std::string buffer;                  // encoded frames not yet written
+    uint64_t bufferFirstLsn;
+    std::shared_ptr<Commit> commit;      // the batch buffer will be written as
+    uint64_t lastLsn;
+    uint64_t durableLsn;
+    int fd;
+    size_t segmentSize;                  // bytes of intact frames in the open segment
+    bool rotate;                         // a failed write could not be cut off
+    std::vector<Segment> segments;
+    long long fsyncs;
+    long long recordsAppended;
+    long long writeErrors;
+    std::thread flusher;
+
+    // Replication
+    std::mutex replMtx;
+    std::condition_variable replCv;
+    std::deque<Record> replQueue;
+    uint64_t replicatedLsn;
+    uint64_t retainedLsn;                // see retainAfter()
+    long long rejectedRecords;
+    Shipper shipper;
+    std::thread replicator;
+
+    std::atomic<bool> stopping;
+
+    std::string segmentPath(uint64_t firstLsn) const;
+    std::string checkpointPath() const;
+    std::string quarantinePath() const;
+    bool openSegment(uint64_t firstLsn);
+    bool writeBatch(const std::string& batch, uint64_t firstLsn);
+    size_t replaySegment(const Segment& segment, const std::function<void(const Record&)>& onRecord);
+    void saveCheckpoint(uint64_t lsn);
+    void quarantine(const std::vector<Record>& batch);
+    void dropReplicatedSegments();
+    void flushLoop();
+    void replicateLoop();
+
+public:
+    explicit MessageLog(const Options& opts = Options());
+    ~MessageLog();
+
+    MessageLog(const MessageLog&) = delete;
+    MessageLog& operator=(const MessageLog&) = delete;
+
+    // Replays every intact record after replayAfter (older ones are already
+    // in a snapshot), truncates a torn tail and opens a fresh segment for new
+    // appends. Unreplicated records are queued for shipping.
+    bool open(const std::function<void(const Record&)>& onReplay, uint64_t replayAfter = 0);
+
+    // Keep segments holding records after lsn even once replicated,
+    // so they can be replayed on top of the snapshot taken at lsn
+    void retainAfter(uint64_t lsn);
+
+    // Blocks until the messages are durable; returns the LSN of the last one,
+    // or 0 if they could not be written
+    uint64_t append(const std::string& userId, const std::vector<Message>& messages);
+    // Same for a clear marker, so replay forgets what came before it
+    uint64_t appendClear(const std::string& userId);
+
+    void startReplication(Shipper ship);
+    void stop();
+
+    Stats getStats();
+
+    static uint32_t crc32(const char* data, size_t length);
+};
+
+#endif // MESSAGELOG_H
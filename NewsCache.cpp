@@ -0,0 +1,226 @@
+#include "NewsCache.h"
+#include "NewsIndex.h"
+#include <algorithm>
+#include <iostream>
+
+NewsCache::NewsCache() : running(false) {}
+
+NewsCache::~NewsCache() {
+    stop();
+}
+
+NewsCache& NewsCache::shared() {
+    static NewsCache instance;
+    return instance;
+}
+
+void NewsCache::configure(const Options& opts) {
+    std::lock_guard<std::mutex> lock(mtx);
+    options = opts;
+}
+
+void NewsCache::setStore(Store s) {
+    std::lock_guard<std::mutex> lock(mtx);
+    store = std::move(s);
+}
+
+void NewsCache::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) return;
+    running = true;
+    refresher = std::thread(&NewsCache::refreshLoop, this);
+}
+
+void NewsCache::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        running = false;
+    }
+    cv.notify_all();
+    if (refresher.joinable()) {
+        refresher.join();
+    }
+}
+
+NewsCache::Entry& NewsCache::entryFor(const std::string& keyword) {
+    auto it = entries.find(keyword);
+    if (it != entries.end()) {
+        recency.splice(recency.begin(), recency, it->second.lru);
+        return it->second;
+    }
+    while (!recency.empty() && entries.size() >= std::max(options.maxEntries, (size_t)1)) {
+        entries.erase(recency.back());
+        recency.pop_back();
+        stats.evictions++;
+    }
+    recency.push_front(keyword);
+    Entry& entry = entries[keyword];
+    entry.lru = recency.begin();
+    return entry;
+}
+
+void NewsCache::erase(const std::string& keyword) {
+    auto it = entries.find(keyword);
+    if (it == entries.end()) return;
+    recency.erase(it->second.lru);
+    entries.erase(it);
+}
+
+bool NewsCache::fetch(const std::string& keyword, std::vector<Article>& articles) {
+    bool isSection;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        isSection = std::find(options.sections.begin(), options.sections.end(), keyword) != options.sections.end();
+    }
+    // Prefetched sections are section queries, not keyword searches;
+    // "general" is the unfiltered front page
+    std::string body = isSection ? GuardianAPI::fetchNews("", 5, keyword == "general" ? "" : keyword)
+                                 : GuardianAPI::fetchNews(keyword, 5);
+    if (body.find("\"status\":\"ok\"") == std::string::npos) {
+        return false;
+    }
+    articles = GuardianAPI::parseNews(body);
+
+    // Every fetch also grows the local index used for offline keyword search
+    // and is stored, so the index can be seeded again after a restart
+    for (const auto& article : articles) {
+        NewsIndex::shared().add(article.title, article.url, article.section, article.date);
+    }
+    Store persist;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        persist = store;
+    }
+    if (persist && !articles.empty()) persist(articles);
+    return true;
+}
+
+void NewsCache::refresh(const std::string& keyword) {
+    std::vector<Article> articles;
+    bool ok = fetch(keyword, articles);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    Entry& entry = entryFor(keyword);
+    entry.refreshing = false;
+    if (ok) {
+        entry.articles = std::move(articles);
+        entry.fetchedAt = Clock::now();
+        stats.refreshes++;
+    } else {
+        stats.refreshFailures++;
+        // Keep the last good copy; drop placeholders that never loaded
+        if (entry.articles.empty()) erase(keyword);
+    }
+}
+
+std::vector<NewsCache::Article> NewsCache::get(const std::string& keyword) {
+    std::unique_lock<std::mutex> lock(mtx);
+
+    popularity[keyword]++;
+    if (popularity.size() > 1024) {
+        // Decay so yesterday's trends make room for today's
+        for (auto it = popularity.begin(); it != popularity.end();) {
+            it->second /= 2;
+            it = it->second == 0 ? popularity.erase(it) : std::next(it);
+        }
+    }
+
+    auto it = entries.find(keyword);
+    if (it != entries.end() && !it->second.articles.empty()) {
+        Entry& entry = entryFor(keyword);
+        auto age = Clock::now() - entry.fetchedAt;
+        if (age < std::chrono::seconds(options.ttlSec)) {
+            stats.hits++;
+            return entry.articles;
+        }
+        if (age < std::chrono::seconds(options.ttlSec + options.staleSec) && running) {
+            // Serve stale, revalidate in the background
+            stats.staleHits++;
+            if (!entry.refreshing) {
+                entry.refreshing = true;
+                refreshQueue.push_back(keyword);
+                cv.notify_one();
+            }
+            return entry.articles;
+        }
+    }
+
+    stats.misses++;
+    std::vector<Article> previous = it != entries.end() ? it->second.articles : std::vector<Article>();
+    lock.unlock();
+
+    std::vector<Article> articles;
+    if (!fetch(keyword, articles)) {
+        // Upstream is down: any copy beats no answer
+        return previous;
+    }
+
+    lock.lock();
+    Entry& entry = entryFor(keyword);
+    entry.articles = articles;
+    entry.fetchedAt = Clock::now();
+    return articles;
+}
+
+std::vector<std::string> NewsCache::prefetchList() const {
+    std::vector<std::string> keywords = options.sections;
+
+    std::vector<std::pair<long long, std::string>> ranked;
+    for (const auto& p : popularity) {
+        ranked.push_back({p.second, p.first});
+    }
+    size_t top = std::min(ranked.size(), (size_t)std::max(options.popularKeywords, 0));
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const std::pair<long long, std::string>& a, const std::pair<long long, std::string>& b) {
+                          return a.first > b.first;
+                      });
+    for (size_t i = 0; i < top; i++) {
+        if (std::find(keywords.begin(), keywords.end(), ranked[i].second) == keywords.end()) {
+            keywords.push_back(ranked[i].second);
+        }
+    }
+    return keywords;
+}
+
+void NewsCache::refreshLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    auto nextPrefetch = Clock::now();
+
+    while (running) {
+        if (refreshQueue.empty() && Clock::now() < nextPrefetch) {
+            cv.wait_until(lock, nextPrefetch, [this] { return !running || !refreshQueue.empty(); });
+            continue;
+        }
+
+        std::vector<std::string> batch(refreshQueue.begin(), refreshQueue.end());
+        refreshQueue.clear();
+
+        if (Clock::now() >= nextPrefetch) {
+            for (const auto& keyword : prefetchList()) {
+                auto it = entries.find(keyword);
+                // Only refetch what is about to expire
+                bool fresh = it != entries.end() && !it->second.articles.empty() &&
+                             Clock::now() - it->second.fetchedAt <
+                                 std::chrono::seconds(options.ttlSec - options.refreshIntervalSec);
+                if (!fresh && std::find(batch.begin(), batch.end(), keyword) == batch.end()) {
+                    batch.push_back(keyword);
+                }
+            }
+            nextPrefetch = Clock::now() + std::chrono::seconds(std::max(options.refreshIntervalSec, 1));
+        }
+
+        lock.unlock();
+        for (const auto& keyword : batch) {
+            refresh(keyword);
+        }
+        lock.lock();
+    }
+}
+
+NewsCache::Stats NewsCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats copy = stats;
+    copy.entries = entries.size();
+    return copy;
+}
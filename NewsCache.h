@@ -0,0 +1,102 @@
+#ifndef NEWSCACHE_H
+#define NEWSCACHE_H
+
+#include "GuardianAPI.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+// TTL cache of Guardian results keyed by query keyword, bounded by LRU.
+// Entries younger than ttl are served from memory; older entries inside the
+// stale window are still served while a background refresh runs
+// (stale-while-revalidate), and the last good copy covers upstream outages.
+// A refresher thread prefetches the top sections and popular keywords.
+class NewsCache {
+public:
+    typedef GuardianAPI::NewsArticle Article;
+    // Persists freshly fetched articles (e.g. to Firebase for the next start)
+    typedef std::function<void(const std::vector<Article>&)> Store;
+
+    struct Options {
+        int ttlSec;
+        int staleSec;                       // extra time stale entries may be served
+        int refreshIntervalSec;             // prefetch schedule
+        int popularKeywords;                // how many hot keywords to prefetch
+        size_t maxEntries;                  // least recently used keywords go first
+        std::vector<std::string> sections;  // Guardian sections always kept warm ("general" = all)
+
+        Options() : ttlSec(300), staleSec(3600), refreshIntervalSec(120), popularKeywords(10), maxEntries(256),
+                    sections({"general", "world", "technology", "business", "sport"}) {}
+    };
+
+    struct Stats {
+        long long hits;
+        long long staleHits;
+        long long misses;
+        long long refreshes;
+        long long refreshFailures;
+        long long evictions;
+        size_t entries;
+
+        Stats() : hits(0), staleHits(0), misses(0), refreshes(0), refreshFailures(0), evictions(0), entries(0) {}
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::vector<Article> articles;
+        Clock::time_point fetchedAt;
+        bool refreshing;
+        std::list<std::string>::iterator lru;
+
+        Entry() : refreshing(false) {}
+    };
+
+    Options options;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recency;             // front = most recently used
+    std::unordered_map<std::string, long long> popularity;
+    std::deque<std::string> refreshQueue;
+    Stats stats;
+    Store store;
+    bool running;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::thread refresher;
+
+    bool fetch(const std::string& keyword, std::vector<Article>& articles);
+    void refresh(const std::string& keyword);
+    void refreshLoop();
+    std::vector<std::string> prefetchList() const;  // caller holds mtx
+    Entry& entryFor(const std::string& keyword);    // caller holds mtx; marks it most recent
+    void erase(const std::string& keyword);         // caller holds mtx
+
+public:
+    NewsCache();
+    ~NewsCache();
+
+    NewsCache(const NewsCache&) = delete;
+    NewsCache& operator=(const NewsCache&) = delete;
+
+    // Process-wide cache
+    static NewsCache& shared();
+
+    void configure(const Options& opts);
+    void setStore(Store s);
+    void start();   // launch the background refresher
+    void stop();
+
+    std::vector<Article> get(const std::string& keyword);
+    Stats getStats() const;
+};
+
+#endif // NEWSCACHE_H
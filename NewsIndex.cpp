@@ -0,0 +1,214 @@
+#include "NewsIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+
+// BM25 parameters and recency boost (half-life in hours)
+static const double BM25_K1 = 1.2;
+static const double BM25_B = 0.75;
+static const double RECENCY_WEIGHT = 0.5;
+static const double RECENCY_HALF_LIFE_HOURS = 24.0;
+
+// Capacity; a full index drops its oldest quarter in one rebuild
+static const size_t MAX_ARTICLES = 50000;
+static const size_t MAX_ARENA_BYTES = UINT32_MAX;   // Span offsets are 32-bit
+
+NewsIndex::NewsIndex() : totalTokens(0) {}
+
+NewsIndex& NewsIndex::shared() {
+    static NewsIndex instance;
+    return instance;
+}
+
+NewsIndex::Span NewsIndex::store(const std::string& value) {
+    Span span;
+    span.offset = (uint32_t)arena.size();
+    span.length = (uint32_t)value.size();
+    arena += value;
+    return span;
+}
+
+std::string NewsIndex::text(const Span& span) const {
+    return arena.substr(span.offset, span.length);
+}
+
+bool NewsIndex::containsUrl(size_t hash, const std::string& url) const {
+    auto range = byUrl.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Span& span = docs[it->second].url;
+        if (arena.compare(span.offset, span.length, url) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<std::string> NewsIndex::tokenize(const std::string& value) {
+    std::vector<std::string> tokens;
+    std::string current;
+    for (char c : value) {
+        if (std::isalnum((unsigned char)c)) {
+            current += (char)std::tolower((unsigned char)c);
+        } else if (!current.empty()) {
+            tokens.push_back(current);
+            current.clear();
+        }
+    }
+    if (!current.empty()) tokens.push_back(current);
+    return tokens;
+}
+
+int64_t NewsIndex::parseDate(const std::string& iso) {
+    int y, m, d, hh = 0, mm = 0, ss = 0;
+    if (sscanf(iso.c_str(), "%d-%d-%dT%d:%d:%d", &y, &m, &d, &hh, &mm, &ss) < 3) {
+        return 0;
+    }
+    // Days from civil date (proleptic Gregorian), avoids timegm portability issues
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    return days * 86400 + hh * 3600 + mm * 60 + ss;
+}
+
+bool NewsIndex::add(const std::string& title, const std::string& url,
+                    const std::string& section, const std::string& date) {
+    if (title.empty() || url.empty()) return false;
+    size_t bytes = title.size() + url.size() + section.size() + date.size();
+    if (bytes > MAX_ARENA_BYTES / 4) return false;
+
+    size_t urlHash = std::hash<std::string>()(url);
+    std::unique_lock<std::shared_timed_mutex> lock(mtx);
+    if (containsUrl(urlHash, url)) return false;
+
+    if (docs.size() >= MAX_ARTICLES) {
+        evictOldest(docs.size() / 4);
+    }
+    while (arena.size() + bytes > MAX_ARENA_BYTES) {
+        evictOldest(std::max<size_t>(docs.size() / 4, 1));
+    }
+    insert(title, url, section, date, urlHash);
+    return true;
+}
+
+// Caller holds the lock and has checked the URL is new
+void NewsIndex::insert(const std::string& title, const std::string& url,
+                       const std::string& section, const std::string& date, size_t urlHash) {
+    uint32_t id = (uint32_t)docs.size();
+    Doc doc;
+    doc.title = store(title);
+    doc.url = store(url);
+    doc.section = store(section);
+    doc.date = store(date);
+    doc.publishedAt = parseDate(date);
+
+    std::vector<std::string> tokens = tokenize(title + " " + section);
+    doc.length = (uint16_t)std::min(tokens.size(), (size_t)UINT16_MAX);
+    docs.push_back(doc);
+    byUrl.insert({urlHash, id});
+    totalTokens += doc.length;
+
+    std::sort(tokens.begin(), tokens.end());
+    for (size_t i = 0; i < tokens.size();) {
+        size_t j = i;
+        while (j < tokens.size() && tokens[j] == tokens[i]) j++;
+        Posting p;
+        p.doc = id;
+        p.tf = (uint16_t)(j - i);
+        postings[tokens[i]].push_back(p);
+        i = j;
+    }
+}
+
+// Drops the first count articles (the oldest) and rebuilds arena, postings
+// and URL map from the rest, so doc ids stay dense. Caller holds the lock.
+void NewsIndex::evictOldest(size_t count) {
+    std::string oldArena;
+    oldArena.swap(arena);
+    std::vector<Doc> kept(docs.begin() + std::min(count, docs.size()), docs.end());
+    docs.clear();
+    postings.clear();
+    byUrl.clear();
+    totalTokens = 0;
+    for (const Doc& doc : kept) {
+        std::string url = oldArena.substr(doc.url.offset, doc.url.length);
+        insert(oldArena.substr(doc.title.offset, doc.title.length), url,
+               oldArena.substr(doc.section.offset, doc.section.length),
+               oldArena.substr(doc.date.offset, doc.date.length), std::hash<std::string>()(url));
+    }
+}
+
+std::vector<NewsIndex::Article> NewsIndex::search(const std::string& query, size_t limit) const {
+    std::vector<Article> results;
+    std::vector<std::string> terms = tokenize(query);
+    if (terms.empty() || limit == 0) return results;
+
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    if (docs.empty()) return results;
+
+    double n = (double)docs.size();
+    double avgLength = (double)totalTokens / n;
+    std::unordered_map<uint32_t, double> scores;
+
+    for (const auto& term : terms) {
+        auto it = postings.find(term);
+        if (it == postings.end()) continue;
+        double df = (double)it->second.size();
+        double idf = std::log(1.0 + (n - df + 0.5) / (df + 0.5));
+        for (const auto& p : it->second) {
+            double tf = p.tf;
+            double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * docs[p.doc].length / avgLength);
+            scores[p.doc] += idf * tf * (BM25_K1 + 1.0) / (tf + norm);
+        }
+    }
+
+    int64_t now = (int64_t)time(nullptr);
+    std::vector<std::pair<double, uint32_t>> ranked;
+    ranked.reserve(scores.size());
+    for (const auto& s : scores) {
+        double boost = 1.0;
+        int64_t published = docs[s.first].publishedAt;
+        if (published > 0) {
+            double ageHours = std::max<int64_t>(now - published, 0) / 3600.0;
+            boost += RECENCY_WEIGHT * std::pow(0.5, ageHours / RECENCY_HALF_LIFE_HOURS);
+        }
+        ranked.push_back({s.second * boost, s.first});
+    }
+
+    size_t top = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+                          return a.first > b.first;
+                      });
+
+    for (size_t i = 0; i < top; i++) {
+        const Doc& doc = docs[ranked[i].second];
+        Article article;
+        article.title = text(doc.title);
+        article.url = text(doc.url);
+        article.section = text(doc.section);
+        article.date = text(doc.date);
+        article.score = ranked[i].first;
+        results.push_back(article);
+    }
+    return results;
+}
+
+size_t NewsIndex::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    return docs.size();
+}
+
+size_t NewsIndex::memoryBytes() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    size_t bytes = arena.capacity() + docs.capacity() * sizeof(Doc);
+    for (const auto& p : postings) {
+        bytes += p.first.capacity() + p.second.capacity() * sizeof(Posting) + 64;
+    }
+    bytes += byUrl.size() * (sizeof(size_t) + sizeof(uint32_t) + 16);
+    return bytes;
+}
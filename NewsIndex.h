@@ -0,0 +1,79 @@
+#ifndef NEWSINDEX_H
+#define NEWSINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+// In-process news store with an inverted index over title and section.
+// Article text lives once in a single arena; postings are (doc, tf) pairs.
+// Search ranks with BM25 and boosts recent articles. Articles are added
+// incrementally as they are fetched, deduplicated by URL; once the index is
+// full (or the arena nears its 32-bit offsets) the oldest ones are evicted.
+class NewsIndex {
+public:
+    struct Article {
+        std::string title;
+        std::string url;
+        std::string section;
+        std::string date;
+        double score;
+    };
+
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Doc {
+        Span title;
+        Span url;
+        Span section;
+        Span date;
+        uint16_t length;        // token count
+        int64_t publishedAt;    // unix seconds, 0 if unknown
+    };
+
+    struct Posting {
+        uint32_t doc;
+        uint16_t tf;
+    };
+
+    std::string arena;
+    std::vector<Doc> docs;
+    std::unordered_map<std::string, std::vector<Posting>> postings;
+    std::unordered_multimap<size_t, uint32_t> byUrl;   // URL hash -> doc
+    uint64_t totalTokens;
+    mutable std::shared_timed_mutex mtx;
+
+    Span store(const std::string& text);
+    std::string text(const Span& span) const;
+    void insert(const std::string& title, const std::string& url,
+                const std::string& section, const std::string& date, size_t urlHash);
+    void evictOldest(size_t count);
+    bool containsUrl(size_t hash, const std::string& url) const;
+    static std::vector<std::string> tokenize(const std::string& text);
+
+public:
+    NewsIndex();
+
+    // Process-wide index
+    static NewsIndex& shared();
+
+    // Returns false if the URL is already indexed
+    bool add(const std::string& title, const std::string& url,
+             const std::string& section, const std::string& date);
+
+    std::vector<Article> search(const std::string& query, size_t limit = 5) const;
+
+    size_t size() const;
+    size_t memoryBytes() const;
+
+    // ISO-8601 "2024-01-31T12:00:00Z" to unix seconds (0 on failure)
+    static int64_t parseDate(const std::string& iso);
+};
+
+#endif // NEWSINDEX_H
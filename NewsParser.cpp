@@ -0,0 +1,335 @@
+#include "NewsParser.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ========== STAGE 1: STRUCTURAL INDEX ==========
+
+// Bitmasks for one 64-byte block
+struct BlockMasks {
+    uint64_t quotes;
+    uint64_t backslashes;
+    uint64_t operators;     // { } [ ] : ,
+};
+
+#if defined(__SSE2__)
+static inline uint64_t matches(__m128i v, char c) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+static inline BlockMasks classify(const char* p) {
+    BlockMasks m = {0, 0, 0};
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}', so two compares cover all brackets
+        __m128i folded = _mm_or_si128(v, caseBit);
+        uint64_t ops = matches(folded, '{') | matches(folded, '}') | matches(v, ':') | matches(v, ',');
+        m.quotes |= matches(v, '"') << (16 * k);
+        m.backslashes |= matches(v, '\\') << (16 * k);
+        m.operators |= ops << (16 * k);
+    }
+    return m;
+}
+#else
+static inline BlockMasks classify(const char* p) {
+    BlockMasks m = {0, 0, 0};
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = 1ULL << i;
+        switch (p[i]) {
+            case '"': m.quotes |= bit; break;
+            case '\\': m.backslashes |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': m.operators |= bit; break;
+            default: break;
+        }
+    }
+    return m;
+}
+#endif
+
+// Bit i set = odd number of quotes at or before i, i.e. inside a string
+static inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+static inline int lowestBit(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+void NewsParser::scanStructurals(const char* data, size_t length, std::vector<uint32_t>& positions) {
+    positions.clear();
+    positions.reserve(length / 6 + 16);
+
+    uint64_t prevInString = 0;   // all ones if the previous block ended inside a string
+    bool pendingEscape = false;  // previous block ended on an unescaped backslash
+    char tail[64];
+
+    for (size_t base = 0; base < length; base += 64) {
+        size_t n = std::min<size_t>(64, length - base);
+        const char* block = data + base;
+        if (n < 64) {
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, n);
+            block = tail;
+        }
+
+        BlockMasks m = classify(block);
+
+        // Escapes are rare in news payloads; resolve them serially only when present
+        uint64_t escaped = 0;
+        if (m.backslashes || pendingEscape) {
+            for (size_t i = 0; i < n; i++) {
+                if (pendingEscape) {
+                    escaped |= 1ULL << i;
+                    pendingEscape = false;
+                } else if ((m.backslashes >> i) & 1) {
+                    pendingEscape = true;
+                }
+            }
+        }
+
+        uint64_t quotes = m.quotes & ~escaped;
+        uint64_t inString = prefixXor(quotes) ^ prevInString;
+        prevInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t structurals = (m.operators & ~inString) | quotes;
+        while (structurals) {
+            positions.push_back((uint32_t)(base + lowestBit(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+}
+
+// ========== STAGE 2: WALK response.results ==========
+
+namespace {
+
+class Walker {
+private:
+    const std::string& json;
+    const std::vector<uint32_t>& idx;
+    size_t i;
+
+public:
+    Walker(const std::string& j, const std::vector<uint32_t>& positions) : json(j), idx(positions), i(0) {}
+
+    char peek() const { return i < idx.size() ? json[idx[i]] : '\0'; }
+
+    bool expect(char c) {
+        if (peek() != c) return false;
+        i++;
+        return true;
+    }
+
+    bool readString(NewsParser::Field& f) {
+        if (peek() != '"' || i + 1 >= idx.size()) return false;
+        uint32_t start = idx[i] + 1;
+        f.offset = start;
+        f.length = idx[i + 1] - start;
+        f.escaped = std::memchr(json.data() + start, '\\', f.length) != nullptr;
+        i += 2;
+        return true;
+    }
+
+    bool is(const NewsParser::Field& f, const char* literal) const {
+        size_t n = std::strlen(literal);
+        return f.length == n && std::memcmp(json.data() + f.offset, literal, n) == 0;
+    }
+
+    // Scalars (numbers, true, false, null) have no structurals, so nothing to skip
+    void skipValue() {
+        char c = peek();
+        if (c == '"') {
+            i += 2;
+        } else if (c == '{' || c == '[') {
+            int depth = 0;
+            do {
+                char d = peek();
+                if (d == '"') {
+                    i += 2;
+                    continue;
+                }
+                if (d == '{' || d == '[') depth++;
+                else if (d == '}' || d == ']') depth--;
+                else if (d == '\0') return;
+                i++;
+            } while (depth > 0);
+        }
+    }
+
+    void readStringValue(NewsParser::Field& f) {
+        if (!readString(f)) skipValue();
+    }
+
+    // Calls onMember(key) with the cursor on each member value; onMember consumes it
+    template <typename F>
+    bool forEachMember(F onMember) {
+        if (!expect('{')) return false;
+        if (expect('}')) return true;
+        for (;;) {
+            NewsParser::Field key;
+            if (!readString(key) || !expect(':')) return false;
+            if (!onMember(key)) return false;
+            if (expect(',')) continue;
+            return expect('}');
+        }
+    }
+};
+
+} // namespace
+
+size_t NewsParser::parse(const std::string& json, std::vector<ArticleRef>& articles, size_t maxArticles) {
+    articles.clear();
+
+    std::vector<uint32_t> positions;
+    scanStructurals(json.data(), json.size(), positions);
+    Walker w(json, positions);
+
+    auto parseArticle = [&](ArticleRef& a) {
+        return w.forEachMember([&](const Field& key) {
+            if (w.is(key, "webTitle")) w.readStringValue(a.title);
+            else if (w.is(key, "webUrl")) w.readStringValue(a.url);
+            else if (w.is(key, "sectionName")) w.readStringValue(a.section);
+            else if (w.is(key, "webPublicationDate")) w.readStringValue(a.date);
+            else if (w.is(key, "fields") && w.peek() == '{') {
+                return w.forEachMember([&](const Field& inner) {
+                    if (w.is(inner, "trailText")) w.readStringValue(a.trailText);
+                    else w.skipValue();
+                    return true;
+                });
+            } else w.skipValue();
+            return true;
+        });
+    };
+
+    auto parseResults = [&]() {
+        if (!w.expect('[')) return false;
+        if (w.expect(']')) return true;
+        for (;;) {
+            if (w.peek() == '{') {
+                ArticleRef a;
+                if (!parseArticle(a)) return false;
+                articles.push_back(a);
+                if (articles.size() >= maxArticles) {
+                    return false;   // stop walking; everything needed is collected
+                }
+            } else {
+                w.skipValue();
+            }
+            if (w.expect(',')) continue;
+            return w.expect(']');
+        }
+    };
+
+    w.forEachMember([&](const Field& key) {
+        if (w.is(key, "response") && w.peek() == '{') {
+            return w.forEachMember([&](const Field& inner) {
+                if (w.is(inner, "results")) return parseResults();
+                w.skipValue();
+                return true;
+            });
+        }
+        w.skipValue();
+        return true;
+    });
+
+    return articles.size();
+}
+
+// ========== FIELD MATERIALIZATION ==========
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool readHex4(const char* p, const char* end, unsigned& out) {
+    if (end - p < 4) return false;
+    out = 0;
+    for (int k = 0; k < 4; k++) {
+        int h = hexValue(p[k]);
+        if (h < 0) return false;
+        out = (out << 4) | (unsigned)h;
+    }
+    return true;
+}
+
+static void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+std::string NewsParser::value(const std::string& json, const Field& field) {
+    const char* p = json.data() + field.offset;
+    if (!field.escaped) {
+        return std::string(p, field.length);
+    }
+
+    const char* end = p + field.length;
+    std::string out;
+    out.reserve(field.length);
+    while (p < end) {
+        if (*p != '\\' || p + 1 >= end) {
+            out += *p++;
+            continue;
+        }
+        char e = p[1];
+        p += 2;
+        switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned cp = 0;
+                if (!readHex4(p, end, cp)) break;
+                p += 4;
+                // Surrogate pair
+                unsigned low = 0;
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    readHex4(p + 2, end, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default: out += e; break;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,45 @@
+#ifndef NEWSPARSER_H
+#define NEWSPARSER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Shared parser for Guardian /search responses.
+// Stage 1 finds every structural character ({}[]:, and unescaped quotes
+// outside strings) 64 bytes at a time with SSE2, simdjson-style. Stage 2
+// walks response.results in one forward pass over that index and records
+// each field as an offset/length into the input - nothing is copied until
+// value() materializes (and unescapes) the fields a caller actually uses.
+class NewsParser {
+public:
+    struct Field {
+        uint32_t offset;
+        uint32_t length;
+        bool escaped;           // contains backslash escapes
+
+        Field() : offset(0), length(0), escaped(false) {}
+        bool empty() const { return length == 0; }
+    };
+
+    struct ArticleRef {
+        Field title;            // webTitle
+        Field url;              // webUrl
+        Field section;          // sectionName
+        Field date;             // webPublicationDate
+        Field trailText;        // fields.trailText
+    };
+
+    // Stage 1: positions of structural characters
+    static void scanStructurals(const char* data, size_t length, std::vector<uint32_t>& positions);
+
+    // Stage 2: articles of response.results (up to maxArticles)
+    static size_t parse(const std::string& json, std::vector<ArticleRef>& articles,
+                        size_t maxArticles = SIZE_MAX);
+
+    // Copy a field out of the source buffer, decoding JSON escapes
+    static std::string value(const std::string& json, const Field& field);
+};
+
+#endif // NEWSPARSER_H
@@ -0,0 +1,130 @@
+#include "ResponseCache.h"
+#include <cctype>
+#include <iterator>
+#include <functional>
+#include <cstdio>
+
+ResponseCache::ResponseCache(size_t maxEntries, int ttlSeconds)
+    : maxEntries(maxEntries), ttl(ttlSeconds) {}
+
+std::string ResponseCache::normalize(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (std::isspace((unsigned char)c)) {
+            pendingSpace = !result.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            result += ' ';
+            pendingSpace = false;
+        }
+        result += (char)std::tolower((unsigned char)c);
+    }
+    while (!result.empty() && (result.back() == '.' || result.back() == '!' || result.back() == '?')) {
+        result.pop_back();
+    }
+    return result;
+}
+
+std::string ResponseCache::hashKey(const std::string& material) {
+    unsigned long long fnv = 14695981039346656037ULL;
+    for (char c : material) {
+        fnv ^= (unsigned char)c;
+        fnv *= 1099511628211ULL;
+    }
+    unsigned long long other = std::hash<std::string>()(material);
+
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx", fnv, other);
+    return std::string(buf);
+}
+
+size_t ResponseCache::entrySize(const Entry& e) {
+    // Key is stored twice (list entry + index), plus node overhead
+    return 2 * e.key.capacity() + e.value.capacity() + sizeof(Entry) + 64;
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator it) {
+    stats.memoryBytes -= entrySize(*it);
+    index.erase(it->key);
+    entries.erase(it);
+}
+
+bool ResponseCache::get(const std::string& key, std::string& value) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (maxEntries == 0) return false;
+
+    auto found = index.find(key);
+    if (found == index.end()) {
+        stats.misses++;
+        return false;
+    }
+
+    auto it = found->second;
+    if (Clock::now() >= it->expires) {
+        erase(it);
+        stats.misses++;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it);
+    stats.hits++;
+    stats.savedLatencyMs += it->latencyMs;
+    value = it->value;
+    return true;
+}
+
+void ResponseCache::put(const std::string& key, const std::string& value, double latencyMs) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (maxEntries == 0) return;
+
+    auto found = index.find(key);
+    if (found != index.end()) {
+        erase(found->second);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.latencyMs = latencyMs;
+    entry.expires = Clock::now() + ttl;
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    stats.memoryBytes += entrySize(entries.front());
+
+    while (entries.size() > maxEntries) {
+        erase(std::prev(entries.end()));
+        stats.evictions++;
+    }
+}
+
+void ResponseCache::configure(size_t newMaxEntries, int ttlSeconds) {
+    std::lock_guard<std::mutex> lock(mtx);
+    maxEntries = newMaxEntries;
+    ttl = std::chrono::seconds(ttlSeconds);
+    while (entries.size() > maxEntries) {
+        erase(std::prev(entries.end()));
+        stats.evictions++;
+    }
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+    index.clear();
+    stats.memoryBytes = 0;
+}
+
+bool ResponseCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return maxEntries > 0;
+}
+
+ResponseCache::Stats ResponseCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats copy = stats;
+    copy.entries = entries.size();
+    return copy;
+}
@@ -0,0 +1,64 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+
+// Bounded LRU cache with TTL for AI completions.
+// Keys are built from model, system prompt and normalized recent context,
+// so identical openers ("hi", "tell me a joke") skip the network round-trip.
+class ResponseCache {
+public:
+    struct Stats {
+        long long hits;
+        long long misses;
+        long long evictions;
+        size_t entries;
+        size_t memoryBytes;
+        double savedLatencyMs;   // upstream latency avoided by hits
+
+        Stats() : hits(0), misses(0), evictions(0), entries(0), memoryBytes(0), savedLatencyMs(0) {}
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::string key;
+        std::string value;
+        double latencyMs;        // cost of the original upstream call
+        Clock::time_point expires;
+    };
+
+    size_t maxEntries;
+    std::chrono::seconds ttl;
+    std::list<Entry> entries;    // front = most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    Stats stats;
+    mutable std::mutex mtx;
+
+    static size_t entrySize(const Entry& e);
+    void erase(std::list<Entry>::iterator it);
+
+public:
+    ResponseCache(size_t maxEntries = 1024, int ttlSeconds = 600);
+
+    // Lowercase, collapse whitespace, drop trailing punctuation
+    static std::string normalize(const std::string& text);
+
+    // 128-bit hex digest of the key material (FNV-1a + std::hash)
+    static std::string hashKey(const std::string& material);
+
+    bool get(const std::string& key, std::string& value);
+    void put(const std::string& key, const std::string& value, double latencyMs);
+    void configure(size_t maxEntries, int ttlSeconds);
+    void clear();
+
+    bool isEnabled() const;
+    Stats getStats() const;
+};
+
+#endif // RESPONSECACHE_H
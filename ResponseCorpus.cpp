@@ -0,0 +1,182 @@
+#include "ResponseCorpus.h"
+#include "EpochReclaimer.h"
+#include "Tokenizer.h"
+#include "json.hpp"
+#include <fstream>
+#include <chrono>
+#include <iostream>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+ResponseCorpus::ResponseCorpus()
+    : current(nullptr), running(false), version(0), failures(0), badLines(0), loadMs(0) {}
+
+ResponseCorpus::~ResponseCorpus() {
+    stop();
+    // Owners stop serving before destruction, so no reader is left
+    delete current.load();
+}
+
+void ResponseCorpus::start(const std::string& corpusPath) {
+    if (running.exchange(true)) return;
+    path = corpusPath;
+    watcher = std::thread(&ResponseCorpus::watchLoop, this);
+}
+
+void ResponseCorpus::stop() {
+    running = false;
+    if (watcher.joinable()) watcher.join();
+}
+
+bool ResponseCorpus::reload() {
+    std::lock_guard<std::mutex> reloadLock(reloadMutex);
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[Corpus] Cannot read " << path << ", keeping the current version" << std::endl;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        failures++;
+        return false;
+    }
+
+    // {"keyword": ..., "response": ...} or {"keyword": ..., "responses": [...]}
+    std::vector<UserResponse> entries;
+    long long bad = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        json entry = json::parse(line, nullptr, false);
+        if (!entry.is_object() || !entry.contains("keyword") || !entry["keyword"].is_string()) {
+            bad++;
+            continue;
+        }
+        UserResponse parsed;
+        parsed.keyword = entry["keyword"].get<std::string>();
+        Tokenizer::fold(parsed.keyword);  // inputs are matched case-folded
+        if (entry.contains("response") && entry["response"].is_string()) {
+            parsed.values.push_back(entry["response"].get<std::string>());
+        }
+        if (entry.contains("responses") && entry["responses"].is_array()) {
+            for (const auto& value : entry["responses"]) {
+                if (value.is_string()) parsed.values.push_back(value.get<std::string>());
+            }
+        }
+        if (parsed.keyword.empty() || parsed.values.empty()) {
+            bad++;
+            continue;
+        }
+        entries.push_back(std::move(parsed));
+    }
+    if (in.bad()) {
+        std::cerr << "[Corpus] Read error in " << path << ", keeping the current version" << std::endl;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        failures++;
+        return false;
+    }
+
+    int buckets = (int)entries.size() | 1;
+    Version* next = new Version(buckets < kMinBuckets ? kMinBuckets : buckets);
+    for (const auto& entry : entries) {
+        for (const auto& value : entry.values) {
+            next->responses.insert(entry.keyword, value);
+        }
+        next->fuzzy.add(entry.keyword);
+        next->ranked.add(entry.keyword);
+    }
+
+    const Version* old = current.exchange(next);
+    if (old) EpochReclaimer::shared().retire([old]() { delete old; });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        version++;
+        badLines = bad;
+        loadMs = ms;
+    }
+    std::cerr << "[Corpus] Loaded " << next->responses.getSize() << " keys from " << path << " in " << ms
+              << " ms" << (bad ? " (" + std::to_string(bad) + " bad lines skipped)" : "") << std::endl;
+    return true;
+}
+
+std::vector<std::string> ResponseCorpus::match(const Matcher& match) const {
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    const Version* loaded = current.load();
+    if (!loaded) return {};
+    return match(loaded->responses, loaded->fuzzy, loaded->ranked);
+}
+
+static time_t modifiedAt(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+// Reloads once the file has been quiet for kSettleMs after a change, so a
+// large file being written is read once, complete
+void ResponseCorpus::watchLoop() {
+    typedef std::chrono::steady_clock Clock;
+    reload();
+
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    int wd = fd >= 0 ? inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) : -1;
+    if (wd < 0) {
+        std::cerr << "[Corpus] inotify unavailable for " << directory << ", polling for changes" << std::endl;
+    }
+
+    time_t lastModified = modifiedAt(path);
+    bool pending = false;
+    Clock::time_point settleAt;
+    while (running) {
+        bool changed = false;
+        if (wd >= 0) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, kPollMs) > 0) {
+                alignas(struct inotify_event) char buffer[4096];
+                ssize_t length;
+                while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length;) {
+                        const struct inotify_event* event = (const struct inotify_event*)p;
+                        if (event->len > 0 && name == event->name) changed = true;
+                        p += sizeof(struct inotify_event) + event->len;
+                    }
+                }
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+            time_t modified = modifiedAt(path);
+            changed = modified != lastModified;
+            lastModified = modified;
+        }
+        if (changed) {
+            pending = true;
+            settleAt = Clock::now() + std::chrono::milliseconds(kSettleMs);
+        }
+        if (pending && Clock::now() >= settleAt) {
+            pending = false;
+            reload();
+        }
+    }
+    if (fd >= 0) close(fd);
+}
+
+ResponseCorpus::Stats ResponseCorpus::getStats() const {
+    Stats stats;
+    stats.path = path;
+    {
+        EpochReclaimer::Guard guard(EpochReclaimer::shared());
+        const Version* loaded = current.load();
+        stats.keys = loaded ? loaded->responses.getSize() : 0;
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.version = version;
+    stats.failures = failures;
+    stats.badLines = badLines;
+    stats.loadMs = loadMs;
+    return stats;
+}
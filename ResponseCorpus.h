@@ -0,0 +1,72 @@
+#ifndef RESPONSECORPUS_H
+#define RESPONSECORPUS_H
+
+#include "UserResponses.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+// Shared responses loaded from a JSONL file, one per line:
+//   {"keyword": "opening hours", "response": "We're open 9 to 5."}
+//   {"keyword": "joke", "responses": ["...", "..."]}
+// A watcher thread reloads the file whenever it changes (inotify on its
+// directory, so editors that save by rename are seen too). Each load is
+// parsed and indexed on that thread and published through an atomic
+// pointer like UserResponses, so lookups never wait for a reload and a
+// file that cannot be read leaves the current version serving.
+class ResponseCorpus {
+public:
+    typedef UserResponses::Matcher Matcher;
+
+    struct Stats {
+        std::string path;
+        size_t keys;
+        long long version;      // loads published
+        long long failures;     // loads that kept the previous version
+        long long badLines;     // skipped in the current version
+        double loadMs;          // parse and index time of the current version
+    };
+
+    ResponseCorpus();
+    ~ResponseCorpus();
+
+    // Loads path on the watcher thread, then again after every change
+    void start(const std::string& path);
+    void stop();
+
+    // Parses and publishes the file now; false (and no change) if unreadable
+    bool reload();
+    // Runs match against the current version; empty if nothing is loaded
+    std::vector<std::string> match(const Matcher& match) const;
+    Stats getStats() const;
+
+private:
+    static const int kMinBuckets = 101;
+    static const int kPollMs = 250;      // how often the watcher checks for stop
+    static const int kSettleMs = 200;    // quiet time before a changed file is read
+
+    struct Version {
+        ResponseMap responses;
+        SymSpellIndex fuzzy;
+        ResponseIndex ranked;
+        explicit Version(int buckets) : responses(buckets) {}
+    };
+
+    std::atomic<const Version*> current;
+    std::string path;
+    std::thread watcher;
+    std::atomic<bool> running;
+    std::mutex reloadMutex;              // one publisher at a time
+
+    mutable std::mutex statsMutex;
+    long long version;
+    long long failures;
+    long long badLines;
+    double loadMs;
+
+    void watchLoop();
+};
+
+#endif // RESPONSECORPUS_H
@@ -0,0 +1,187 @@
+#include "ResponseIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// BM25 parameters, as in NewsIndex
+static const double BM25_K1 = 1.2;
+static const double BM25_B = 0.75;
+
+ResponseIndex::ResponseIndex() : totalTokens(0), minLength(UINT16_MAX), maxTf(0) {}
+
+bool ResponseIndex::containsKey(size_t hash, const std::string& key) const {
+    auto range = byKey.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Span& span = docs[it->second].key;
+        if (arena.compare(span.offset, span.length, key) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<std::string> ResponseIndex::tokenize(const std::string& value) {
+    Tokenizer tokenizer;
+    tokenizer.tokenize(value);
+    std::vector<std::string> tokens;
+    for (const TokenView& token : tokenizer.tokens()) {
+        tokens.push_back(token.str());
+    }
+    return tokens;
+}
+
+bool ResponseIndex::add(const std::string& key) {
+    std::vector<std::string> tokens = tokenize(key);
+    if (tokens.empty()) return false;
+
+    size_t keyHash = std::hash<std::string>()(key);
+    if (containsKey(keyHash, key)) return false;
+
+    uint32_t id = (uint32_t)docs.size();
+    Doc doc;
+    doc.key.offset = (uint32_t)arena.size();
+    doc.key.length = (uint32_t)key.size();
+    arena += key;
+    doc.length = (uint16_t)std::min(tokens.size(), (size_t)UINT16_MAX);
+    docs.push_back(doc);
+    byKey.insert({keyHash, id});
+    totalTokens += doc.length;
+    minLength = std::min(minLength, doc.length);
+
+    std::sort(tokens.begin(), tokens.end());
+    for (size_t i = 0; i < tokens.size();) {
+        size_t j = i;
+        while (j < tokens.size() && tokens[j] == tokens[i]) j++;
+        Posting p;
+        p.doc = id;
+        p.tf = (uint16_t)std::min(j - i, (size_t)UINT16_MAX);
+        p.length = doc.length;
+        maxTf = std::max(maxTf, p.tf);
+        postings[tokens[i]].push_back(p);
+        i = j;
+    }
+    return true;
+}
+
+bool ResponseIndex::best(const std::vector<TokenView>& terms, std::string& key, double& score) const {
+    if (terms.empty() || docs.empty()) return false;
+
+    double n = (double)docs.size();
+    double avgLength = (double)totalTokens / n;
+    double shortestNorm = BM25_K1 * (1.0 - BM25_B + BM25_B * minLength / avgLength);
+
+    // Query terms with their lists, idf and the most any one key can gain
+    // from them; rarest (highest bound) first
+    struct Term {
+        const std::vector<Posting>* list;
+        double idf;
+        double bound;
+    };
+    static thread_local std::vector<TokenView> unique;
+    static thread_local std::vector<Term> query;
+    static thread_local std::string lookupKey;
+    unique.assign(terms.begin(), terms.end());
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    query.clear();
+    for (const auto& term : unique) {
+        lookupKey.assign(term.data, term.size);
+        auto it = postings.find(lookupKey);
+        if (it == postings.end()) continue;
+        double df = (double)it->second.size();
+        double idf = std::log(1.0 + (n - df + 0.5) / (df + 0.5));
+        query.push_back({&it->second, idf, idf * maxTf * (BM25_K1 + 1.0) / (maxTf + shortestNorm)});
+    }
+    std::sort(query.begin(), query.end(), [](const Term& a, const Term& b) { return a.bound > b.bound; });
+
+    // Dense per-key accumulators, reused across calls; only touched slots are
+    // read and they are reset again before returning
+    struct Accumulator {
+        double score;
+        uint32_t matched;   // distinct query terms found in the key
+        uint32_t length;
+    };
+    static thread_local std::vector<Accumulator> acc;
+    static thread_local std::vector<uint32_t> touched;
+    if (acc.size() < docs.size()) acc.resize(docs.size(), Accumulator{0.0, 0, 0});
+    touched.clear();
+
+    auto termScore = [&](const Term& term, const Posting& p) {
+        double tf = p.tf;
+        double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * p.length / avgLength);
+        return term.idf * tf * (BM25_K1 + 1.0) / (tf + norm);
+    };
+    // A single shared word is not enough to answer with a long phrase key
+    auto covered = [](const Accumulator& a) { return a.matched * 2 > a.length; };
+
+    double remaining = 0;
+    for (const Term& term : query) remaining += term.bound;
+    double threshold = 0;  // score of the best covered key so far
+    size_t t = 0;
+    for (; t < query.size() && remaining >= threshold; t++) {
+        for (const Posting& p : *query[t].list) {
+            Accumulator& a = acc[p.doc];
+            if (a.matched++ == 0) {
+                touched.push_back(p.doc);
+                a.length = p.length;
+            }
+            a.score += termScore(query[t], p);
+            if (covered(a)) threshold = std::max(threshold, a.score);
+        }
+        remaining -= query[t].bound;
+    }
+    // A key none of the scanned terms reached scores at most `remaining`,
+    // below a key we already have: the rest only add to keys in the running,
+    // and only to those that could still reach the threshold. Lists are in
+    // doc order, so candidates in doc order are found by galloping forward.
+    if (t < query.size()) {
+        static thread_local std::vector<uint32_t> candidates;
+        candidates.clear();
+        for (uint32_t doc : touched) {
+            if (acc[doc].score + remaining >= threshold) candidates.push_back(doc);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (; t < query.size(); t++) {
+            const std::vector<Posting>& list = *query[t].list;
+            size_t pos = 0;
+            for (uint32_t doc : candidates) {
+                size_t step = 1;
+                while (pos + step < list.size() && list[pos + step].doc < doc) step *= 2;
+                auto it = std::lower_bound(list.begin() + pos, list.begin() + std::min(pos + step, list.size()), doc,
+                                           [](const Posting& p, uint32_t d) { return p.doc < d; });
+                pos = it - list.begin();
+                if (pos == list.size()) break;
+                if (it->doc != doc) continue;
+                acc[doc].matched++;
+                acc[doc].score += termScore(query[t], *it);
+            }
+        }
+    }
+
+    bool found = false;
+    uint32_t bestDoc = 0;
+    double bestScore = 0;
+    for (uint32_t doc : touched) {
+        Accumulator& a = acc[doc];
+        if (covered(a) && (!found || a.score > bestScore || (a.score == bestScore && doc < bestDoc))) {
+            found = true;
+            bestDoc = doc;
+            bestScore = a.score;
+        }
+        a.score = 0.0;
+        a.matched = 0;
+    }
+    if (!found) return false;
+
+    const Span& span = docs[bestDoc].key;
+    key = arena.substr(span.offset, span.length);
+    score = bestScore;
+    return true;
+}
+
+size_t ResponseIndex::memoryBytes() const {
+    size_t bytes = arena.capacity() + docs.capacity() * sizeof(Doc);
+    for (const auto& p : postings) {
+        bytes += p.first.capacity() + p.second.capacity() * sizeof(Posting) + 64;
+    }
+    bytes += byKey.size() * (sizeof(size_t) + sizeof(uint32_t) + 16);
+    return bytes;
+}
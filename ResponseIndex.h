@@ -0,0 +1,62 @@
+#ifndef RESPONSEINDEX_H
+#define RESPONSEINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Tokenizer.h"
+
+// Inverted index over response keys ("joke", "how are you"). Key text lives
+// once in an arena; postings are (key, tf) pairs. A query is scored against
+// every key sharing a term with BM25, so "what is the weather joke" picks the
+// rare, specific keys over "what". Common terms' long lists are only probed
+// for keys already in the running once they can no longer change the winner.
+// Built by its owner and then only read, so it takes no lock.
+class ResponseIndex {
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Doc {
+        Span key;
+        uint16_t length;        // token count
+    };
+
+    struct Posting {
+        uint32_t doc;
+        uint16_t tf;
+        uint16_t length;        // the key's, in what would be padding, so
+                                // scoring never has to load its Doc
+    };
+
+    std::string arena;
+    std::vector<Doc> docs;
+    std::unordered_map<std::string, std::vector<Posting>> postings;
+    std::unordered_multimap<size_t, uint32_t> byKey;   // key hash -> doc
+    uint64_t totalTokens;
+    uint16_t minLength;     // bounds a term's best possible score
+    uint16_t maxTf;
+
+    bool containsKey(size_t hash, const std::string& key) const;
+
+public:
+    ResponseIndex();
+
+    // Returns false if the key is already indexed or has no terms
+    bool add(const std::string& key);
+
+    // Highest-scoring key for the query terms (ties go to the key added
+    // first); false if no key has more than half of its own terms matched
+    bool best(const std::vector<TokenView>& terms, std::string& key, double& score) const;
+
+    size_t size() const { return docs.size(); }
+    size_t memoryBytes() const;
+
+    // The words Tokenizer finds in text, so keys and inputs split alike
+    static std::vector<std::string> tokenize(const std::string& text);
+};
+
+#endif // RESPONSEINDEX_H
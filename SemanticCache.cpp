@@ -0,0 +1,291 @@
+#include "SemanticCache.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const float kWordWeight = 1.0f;
+static const float kGramWeight = 0.5f;   // trigrams absorb typos and inflections
+
+// Words that rephrasing adds or drops without changing the question
+// ("what's" splits into "what" "s")
+static bool isFiller(const TokenView& token) {
+    static const char* const fillers[] = {
+        "a", "an", "the", "is", "s", "are", "re", "am", "m", "was", "do", "does", "did",
+        "to", "of", "please", "can", "could", "would", "me", "tell",
+    };
+    for (const char* filler : fillers) {
+        if (token == filler) return true;
+    }
+    return false;
+}
+
+static uint64_t fnv1a(const char* data, size_t length, uint64_t seed) {
+    uint64_t h = seed;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Signed feature hashing: collisions cancel out on average instead of
+// piling up in one direction
+static void addFeature(float* out, uint64_t h, float weight) {
+    out[h % SemanticCache::kDimensions] += (h >> 63) ? -weight : weight;
+}
+
+void SemanticCache::embed(const std::string& text, float* out) {
+    static thread_local Tokenizer tokenizer;
+    tokenizer.tokenize(text);
+    std::fill(out, out + kDimensions, 0.0f);
+
+    const std::vector<TokenView>& tokens = tokenizer.tokens();
+    bool allFiller = std::all_of(tokens.begin(), tokens.end(), isFiller);
+    char gram[3];
+    for (const TokenView& token : tokens) {
+        if (!allFiller && isFiller(token)) continue;
+        addFeature(out, fnv1a(token.data, token.size, 14695981039346656037ULL), kWordWeight);
+        // Trigrams of " word ", so short words still have some
+        for (uint32_t i = 0; i < token.size; i++) {
+            for (uint32_t k = 0; k < 3; k++) {
+                uint32_t at = i + k;   // position in " word "
+                gram[k] = at == 0 || at == token.size + 1 ? ' ' : token.data[at - 1];
+            }
+            addFeature(out, fnv1a(gram, 3, 0x9E3779B97F4A7C15ULL), kGramWeight);
+        }
+    }
+
+    float norm = std::sqrt(dot(out, out));
+    if (norm == 0.0f) return;
+    for (int i = 0; i < kDimensions; i++) out[i] /= norm;
+}
+
+float SemanticCache::dot(const float* a, const float* b) {
+    int i = 0;
+    float sum = 0.0f;
+#if defined(__SSE2__)
+    // Two accumulators hide the add latency
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= kDimensions; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < kDimensions; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+SemanticCache::SemanticCache(const Options& opts)
+    : hits(0), misses(0), evictions(0), savedLatencyUs(0), lookupLatency(1024) {
+    configure(opts);
+}
+
+void SemanticCache::configure(const Options& opts) {
+    std::unique_lock<std::shared_timed_mutex> lock(mtx);
+    options = opts;
+    if (options.lists < 1) options.lists = 1;
+    if (options.probes < 1) options.probes = 1;
+    entries.clear();
+    entries.shrink_to_fit();
+    lists.assign(1, List());
+    centroids.clear();
+    trained = false;
+    nextSlot = 0;
+}
+
+void SemanticCache::clear() {
+    Options current;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mtx);
+        current = options;
+    }
+    configure(current);
+}
+
+bool SemanticCache::isEnabled() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    return options.maxEntries > 0;
+}
+
+bool SemanticCache::get(uint64_t context, const std::string& prompt, std::string& answer) {
+    auto start = Clock::now();
+    float query[kDimensions];
+    embed(prompt, query);
+
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    if (options.maxEntries == 0) return false;
+
+    Clock::time_point now = Clock::now();
+    float best = -2.0f;
+    long long bestSlot = -1;
+    auto scan = [&](const List& list) {
+        for (size_t i = 0; i < list.slots.size(); i++) {
+            if (list.contexts[i] != context) continue;
+            float similarity = dot(query, &list.vectors[i * kDimensions]);
+            if (similarity > best && entries[list.slots[i]].expires > now) {
+                best = similarity;
+                bestSlot = list.slots[i];
+            }
+        }
+    };
+
+    if (!trained) {
+        scan(lists[0]);
+    } else {
+        // Nearest partitions first; probes of them are searched
+        std::vector<std::pair<float, uint32_t>> order(lists.size());
+        for (size_t l = 0; l < lists.size(); l++) {
+            order[l] = std::make_pair(-dot(query, &centroids[l * kDimensions]), (uint32_t)l);
+        }
+        size_t probes = std::min(order.size(), (size_t)options.probes);
+        std::partial_sort(order.begin(), order.begin() + probes, order.end());
+        for (size_t p = 0; p < probes; p++) scan(lists[order[p].second]);
+    }
+
+    bool hit = bestSlot >= 0 && best >= options.threshold;
+    if (hit) {
+        const Entry& e = entries[bestSlot];
+        answer = e.answer;
+        hits++;
+        savedLatencyUs += (long long)(e.latencyMs * 1000.0);
+    } else {
+        misses++;
+    }
+    lookupLatency.record(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    return hit;
+}
+
+void SemanticCache::put(uint64_t context, const std::string& prompt, const std::string& answer, double latencyMs) {
+    float vector[kDimensions];
+    embed(prompt, vector);
+    if (dot(vector, vector) == 0.0f) return;   // nothing to match on
+
+    std::unique_lock<std::shared_timed_mutex> lock(mtx);
+    if (options.maxEntries == 0) return;
+
+    uint32_t slot;
+    if (entries.size() < options.maxEntries) {
+        slot = (uint32_t)entries.size();
+        entries.push_back(Entry());
+    } else {
+        // Full: the oldest entry makes room, the last member of its list
+        // moving into its place
+        slot = (uint32_t)nextSlot;
+        nextSlot = (nextSlot + 1) % options.maxEntries;
+        List& old = lists[entries[slot].list];
+        size_t at = std::find(old.slots.begin(), old.slots.end(), slot) - old.slots.begin();
+        size_t last = old.slots.size() - 1;
+        old.slots[at] = old.slots[last];
+        old.contexts[at] = old.contexts[last];
+        std::copy(&old.vectors[last * kDimensions], &old.vectors[last * kDimensions] + kDimensions,
+                  &old.vectors[at * kDimensions]);
+        old.slots.pop_back();
+        old.contexts.pop_back();
+        old.vectors.resize(last * kDimensions);
+        evictions++;
+    }
+
+    Entry& e = entries[slot];
+    e.answer = answer;
+    e.latencyMs = latencyMs;
+    e.expires = Clock::now() + std::chrono::seconds(options.ttlSec);
+    add(trained ? nearestList(vector) : 0, slot, context, vector);
+
+    if (!trained && options.lists > 1 && entries.size() >= (size_t)options.lists * kTrainPerList) {
+        train();
+    }
+}
+
+void SemanticCache::add(uint32_t list, uint32_t slot, uint64_t context, const float* v) {
+    entries[slot].list = list;
+    lists[list].slots.push_back(slot);
+    lists[list].contexts.push_back(context);
+    lists[list].vectors.insert(lists[list].vectors.end(), v, v + kDimensions);
+}
+
+uint32_t SemanticCache::nearestList(const float* v) const {
+    uint32_t best = 0;
+    float bestScore = -2.0f;
+    for (size_t l = 0; l < lists.size(); l++) {
+        float score = dot(v, &centroids[l * kDimensions]);
+        if (score > bestScore) {
+            bestScore = score;
+            best = (uint32_t)l;
+        }
+    }
+    return best;
+}
+
+// Spherical k-means over the entries so far, seeded with evenly spaced
+// ones; later entries join the partition of their nearest centroid
+void SemanticCache::train() {
+    List all;
+    all.slots.swap(lists[0].slots);
+    all.contexts.swap(lists[0].contexts);
+    all.vectors.swap(lists[0].vectors);
+    const std::vector<float>& vectors = all.vectors;
+    size_t count = all.slots.size();
+    size_t k = (size_t)options.lists;
+    centroids.assign(k * kDimensions, 0.0f);
+    for (size_t l = 0; l < k; l++) {
+        const float* seed = &vectors[(l * count / k) * kDimensions];
+        std::copy(seed, seed + kDimensions, &centroids[l * kDimensions]);
+    }
+
+    std::vector<uint32_t> assignment(count, 0);
+    std::vector<float> sums(k * kDimensions);
+    for (int iteration = 0; iteration < kTrainIterations; iteration++) {
+        for (size_t slot = 0; slot < count; slot++) {
+            assignment[slot] = nearestList(&vectors[slot * kDimensions]);
+        }
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        for (size_t slot = 0; slot < count; slot++) {
+            float* sum = &sums[assignment[slot] * kDimensions];
+            const float* v = &vectors[slot * kDimensions];
+            for (int i = 0; i < kDimensions; i++) sum[i] += v[i];
+        }
+        for (size_t l = 0; l < k; l++) {
+            float* sum = &sums[l * kDimensions];
+            float norm = std::sqrt(dot(sum, sum));
+            if (norm == 0.0f) continue;   // empty partition keeps its centroid
+            for (int i = 0; i < kDimensions; i++) centroids[l * kDimensions + i] = sum[i] / norm;
+        }
+    }
+
+    lists.assign(k, List());
+    for (size_t i = 0; i < count; i++) {
+        const float* v = &vectors[i * kDimensions];
+        add(nearestList(v), all.slots[i], all.contexts[i], v);
+    }
+    trained = true;
+}
+
+SemanticCache::Stats SemanticCache::getStats() const {
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.savedLatencyMs = savedLatencyUs / 1000.0;
+    stats.lookupP50Us = lookupLatency.percentile(0.50);
+    stats.lookupP95Us = lookupLatency.percentile(0.95);
+
+    std::shared_lock<std::shared_timed_mutex> lock(mtx);
+    stats.entries = entries.size();
+    stats.trained = trained;
+    stats.memoryBytes = centroids.capacity() * sizeof(float) + entries.capacity() * sizeof(Entry);
+    for (const Entry& e : entries) stats.memoryBytes += e.answer.capacity();
+    for (const List& list : lists) {
+        stats.memoryBytes += list.slots.capacity() * sizeof(uint32_t) + list.contexts.capacity() * sizeof(uint64_t) +
+                             list.vectors.capacity() * sizeof(float);
+    }
+    return stats;
+}
@@ -0,0 +1,106 @@
+#ifndef SEMANTICCACHE_H
+#define SEMANTICCACHE_H
+
+#include "LatencyTracker.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <shared_mutex>
+
+// Answers for prompts that mean the same as an earlier one ("what's your
+// name" after "what is your name"), where ResponseCache only catches
+// identical text. Prompts are embedded by hashing their content words and
+// character trigrams into a fixed vector; the nearest earlier prompt under
+// the same conversation context is found with an IVF index (a flat scan
+// until there are enough prompts to train its centroids) and SIMD dot
+// products. Bounded, first in first out, with a TTL.
+class SemanticCache {
+public:
+    static const int kDimensions = 256;
+
+    struct Options {
+        size_t maxEntries;       // 0 = disabled
+        float threshold;         // cosine similarity needed for a hit
+        int lists;               // IVF partitions (1 = always a flat scan)
+        int probes;              // partitions searched per lookup (recall vs latency)
+        int ttlSec;
+
+        Options() : maxEntries(2048), threshold(0.9f), lists(32), probes(4), ttlSec(600) {}
+    };
+
+    struct Stats {
+        long long hits;
+        long long misses;
+        long long evictions;
+        size_t entries;
+        bool trained;            // searching by partition rather than flat
+        double savedLatencyMs;   // upstream latency avoided by hits
+        double lookupP50Us;
+        double lookupP95Us;
+        size_t memoryBytes;
+
+        Stats() : hits(0), misses(0), evictions(0), entries(0), trained(false), savedLatencyMs(0),
+                  lookupP50Us(0), lookupP95Us(0), memoryBytes(0) {}
+    };
+
+    explicit SemanticCache(const Options& options = Options());
+
+    // Applies the options and drops every entry
+    void configure(const Options& options);
+    void clear();
+    bool isEnabled() const;
+
+    // Answer cached for the most similar earlier prompt under the same
+    // context, if it is at least threshold-similar
+    bool get(uint64_t context, const std::string& prompt, std::string& answer);
+    void put(uint64_t context, const std::string& prompt, const std::string& answer, double latencyMs);
+
+    Stats getStats() const;
+
+    // Unit vector of kDimensions floats for text (all zero if it has no words)
+    static void embed(const std::string& text, float* out);
+    static float dot(const float* a, const float* b);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int kTrainPerList = 8;    // prompts per partition before training
+    static const int kTrainIterations = 5;
+
+    struct Entry {
+        std::string answer;
+        double latencyMs;
+        Clock::time_point expires;
+        uint32_t list;
+    };
+
+    // A partition's members stored contiguously, so a probe streams through
+    // memory instead of jumping between slots
+    struct List {
+        std::vector<uint32_t> slots;
+        std::vector<uint64_t> contexts;
+        std::vector<float> vectors;          // kDimensions floats per member
+    };
+
+    Options options;
+    std::vector<Entry> entries;              // slot -> entry
+    std::vector<List> lists;                 // one list until trained
+    std::vector<float> centroids;            // kDimensions floats per partition
+    bool trained;
+    size_t nextSlot;                         // oldest slot, overwritten once full
+    mutable std::shared_timed_mutex mtx;
+
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+    std::atomic<long long> evictions;
+    std::atomic<long long> savedLatencyUs;
+    LatencyTracker lookupLatency;
+
+    uint32_t nearestList(const float* v) const;
+    void add(uint32_t list, uint32_t slot, uint64_t context, const float* v);
+    void train();
+};
+
+#endif // SEMANTICCACHE_H
@@ -0,0 +1,75 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <string>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+// Coalesces concurrent identical upstream calls.
+// The first caller for a key (the leader) runs the call; callers that arrive
+// while it is in flight wait on the same result instead of issuing their own.
+template <typename T>
+class SingleFlight {
+private:
+    std::mutex mtx;
+    std::unordered_map<std::string, std::shared_future<T>> calls;
+    std::atomic<long long> executed;
+    std::atomic<long long> coalesced;
+
+public:
+    SingleFlight() : executed(0), coalesced(0) {}
+
+    typedef std::chrono::steady_clock Clock;
+
+    T run(const std::string& key, const std::function<T()>& fn) {
+        return run(key, fn, Clock::time_point::max(), T());
+    }
+
+    // A waiting caller gives up at its own deadline and gets onTimeout;
+    // the leader's call is bounded by fn itself
+    T run(const std::string& key, const std::function<T()>& fn, Clock::time_point deadline, const T& onTimeout) {
+        std::promise<T> promise;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            auto it = calls.find(key);
+            if (it != calls.end()) {
+                std::shared_future<T> pending = it->second;
+                lock.unlock();
+                coalesced++;
+                if (deadline != Clock::time_point::max() &&
+                    pending.wait_until(deadline) != std::future_status::ready) {
+                    return onTimeout;
+                }
+                return pending.get();
+            }
+            calls[key] = promise.get_future().share();
+        }
+
+        executed++;
+        try {
+            T result = fn();
+            promise.set_value(result);
+            forget(key);
+            return result;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            forget(key);
+            throw;
+        }
+    }
+
+    long long getExecuted() const { return executed.load(); }
+    long long getCoalesced() const { return coalesced.load(); }
+
+private:
+    void forget(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mtx);
+        calls.erase(key);
+    }
+};
+
+#endif // SINGLEFLIGHT_H
@@ -0,0 +1,286 @@
+#include "Snapshot.h"
+#include "MessageLog.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace snapshot;
+
+static const char kMagic[8] = {'C', 'B', 'S', 'N', 'A', 'P', '\0', '\1'};
+static const uint32_t kVersion = 3;  // v2: responses carry their owning user; v3: cleared users
+
+static uint32_t headerCrc(Header h) {
+    h.headerCrc = 0;
+    return MessageLog::crc32(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+// ========== WRITER ==========
+
+bool SnapshotWriter::fits(size_t used, size_t more) {
+    if (more > UINT32_MAX || used > UINT32_MAX - more) overflow = true;
+    return !overflow;
+}
+
+StrRef SnapshotWriter::intern(const std::string& s) {
+    StrRef ref;
+    ref.offset = 0;
+    ref.length = 0;
+    if (!fits(strings.size(), s.size())) return ref;
+    ref.offset = (uint32_t)strings.size();
+    ref.length = (uint32_t)s.size();
+    strings += s;
+    return ref;
+}
+
+void SnapshotWriter::addSession(const std::string& userId, const std::string& summary, const Turns& sessionTurns) {
+    PendingSession pending;
+    pending.userId = userId;
+    pending.rec.userId = intern(userId);
+    pending.rec.summary = intern(summary);
+    if (!fits(turns.size(), sessionTurns.size())) return;
+    pending.rec.firstTurn = (uint32_t)turns.size();
+    pending.rec.turnCount = (uint32_t)sessionTurns.size();
+    for (const auto& turn : sessionTurns) {
+        TurnRec rec;
+        rec.role = intern(turn.first);
+        rec.content = intern(turn.second);
+        turns.push_back(rec);
+    }
+    sessions.push_back(pending);
+}
+
+void SnapshotWriter::addMessage(const Message& msg) {
+    MessageRec rec;
+    rec.content = intern(msg.content);
+    rec.sender = intern(msg.sender);
+    rec.timestamp = intern(msg.timestamp);
+    messages.push_back(rec);
+}
+
+void SnapshotWriter::addResponse(const UserResponse& response) {
+    if (!fits(values.size(), response.values.size())) return;
+    ResponseRec rec;
+    rec.userId = intern(response.userId);
+    rec.key = intern(response.keyword);
+    rec.firstValue = (uint32_t)values.size();
+    rec.valueCount = (uint32_t)response.values.size();
+    for (const auto& value : response.values) {
+        values.push_back(intern(value));
+    }
+    responses.push_back(rec);
+}
+
+void SnapshotWriter::addClearedUser(const std::string& userId) {
+    cleared.push_back(intern(userId));
+}
+
+template <typename T>
+static void appendSection(std::string& file, Section& section, const std::vector<T>& items) {
+    while (file.size() % 8) file += '\0';
+    section.offset = file.size();
+    section.count = items.size();
+    if (!items.empty()) {
+        file.append(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(T));
+    }
+}
+
+bool SnapshotWriter::write(const std::string& path, uint64_t walLsn) {
+    if (overflow) {
+        std::cerr << "[Snapshot] State exceeds the 4 GiB section limit, not writing " << path << std::endl;
+        return false;
+    }
+    // Sorted by userId so lookups binary-search the mapping
+    std::sort(sessions.begin(), sessions.end(),
+              [](const PendingSession& a, const PendingSession& b) { return a.userId < b.userId; });
+    std::vector<SessionRec> sessionRecs;
+    sessionRecs.reserve(sessions.size());
+    for (const auto& pending : sessions) sessionRecs.push_back(pending.rec);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.walLsn = walLsn;
+    header.createdUnix = (uint64_t)time(nullptr);
+
+    std::string file(sizeof(Header), '\0');
+    appendSection(file, header.sessions, sessionRecs);
+    appendSection(file, header.turns, turns);
+    appendSection(file, header.messages, messages);
+    appendSection(file, header.responses, responses);
+    appendSection(file, header.values, values);
+    appendSection(file, header.cleared, cleared);
+    while (file.size() % 8) file += '\0';
+    header.strings.offset = file.size();
+    header.strings.count = strings.size();
+    file += strings;
+
+    header.fileSize = file.size();
+    header.headerCrc = headerCrc(header);
+    std::memcpy(&file[0], &header, sizeof(header));
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "[Snapshot] Cannot create " << tmp << std::endl;
+        return false;
+    }
+    const char* p = file.data();
+    size_t left = file.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) break;
+        p += n;
+        left -= (size_t)n;
+    }
+    bool ok = left == 0 && fsync(fd) == 0;
+    close(fd);
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "[Snapshot] Failed to write " << path << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable before callers drop what the file covers
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd < 0 || fsync(dirFd) != 0) {
+        std::cerr << "[Snapshot] Cannot sync directory of " << path << std::endl;
+        if (dirFd >= 0) close(dirFd);
+        return false;
+    }
+    close(dirFd);
+    return true;
+}
+
+// ========== VIEW ==========
+
+SnapshotView::SnapshotView() : base(nullptr), size(0), header(nullptr) {}
+
+SnapshotView::~SnapshotView() {
+    if (base) {
+        munmap(const_cast<char*>(base), size);
+    }
+}
+
+static bool sectionFits(const Section& s, size_t recordSize, size_t fileSize) {
+    return s.offset % 8 == 0 && s.offset <= fileSize && s.count <= (fileSize - s.offset) / recordSize;
+}
+
+bool SnapshotView::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+    base = static_cast<const char*>(mapped);
+    size = (size_t)st.st_size;
+
+    // Only the header and section bounds are checked: O(1) in the data size
+    const Header* h = reinterpret_cast<const Header*>(base);
+    bool valid = std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0 && h->version == kVersion &&
+                 h->headerCrc == headerCrc(*h) && h->fileSize == size &&
+                 sectionFits(h->sessions, sizeof(SessionRec), size) &&
+                 sectionFits(h->turns, sizeof(TurnRec), size) &&
+                 sectionFits(h->messages, sizeof(MessageRec), size) &&
+                 sectionFits(h->responses, sizeof(ResponseRec), size) &&
+                 sectionFits(h->values, sizeof(StrRef), size) &&
+                 sectionFits(h->cleared, sizeof(StrRef), size) &&
+                 h->strings.offset <= size && h->strings.count <= size - h->strings.offset;
+    if (!valid) {
+        std::cerr << "[Snapshot] " << path << " is not a valid snapshot, ignoring it" << std::endl;
+        munmap(mapped, size);
+        base = nullptr;
+        size = 0;
+        return false;
+    }
+    header = h;
+    return true;
+}
+
+std::string SnapshotView::str(const StrRef& ref) const {
+    // Out-of-range references read as empty rather than past the mapping
+    if (!header || (uint64_t)ref.offset + ref.length > header->strings.count) return "";
+    return std::string(base + header->strings.offset + ref.offset, ref.length);
+}
+
+const SessionRec& SnapshotView::sessionAt(size_t i) const {
+    return section<SessionRec>(header->sessions)[i];
+}
+
+const SessionRec* SnapshotView::findSession(const std::string& userId) const {
+    if (!header) return nullptr;
+    const SessionRec* first = section<SessionRec>(header->sessions);
+    size_t lo = 0, hi = header->sessions.count;
+    const char* pool = base + header->strings.offset;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const StrRef& ref = first[mid].userId;
+        if ((uint64_t)ref.offset + ref.length > header->strings.count) return nullptr;
+        int cmp = std::string::traits_type::compare(pool + ref.offset, userId.data(),
+                                                    std::min<size_t>(ref.length, userId.size()));
+        if (cmp == 0) cmp = ref.length < userId.size() ? -1 : (ref.length > userId.size() ? 1 : 0);
+        if (cmp == 0) return &first[mid];
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return nullptr;
+}
+
+Turns SnapshotView::turnsOf(const SessionRec& session) const {
+    Turns result;
+    if (!header || (uint64_t)session.firstTurn + session.turnCount > header->turns.count) return result;
+    const TurnRec* recs = section<TurnRec>(header->turns) + session.firstTurn;
+    for (uint32_t i = 0; i < session.turnCount; i++) {
+        result.push_back({str(recs[i].role), str(recs[i].content)});
+    }
+    return result;
+}
+
+std::vector<Message> SnapshotView::messages() const {
+    std::vector<Message> result;
+    if (!header) return result;
+    const MessageRec* recs = section<MessageRec>(header->messages);
+    for (uint64_t i = 0; i < header->messages.count; i++) {
+        result.push_back(Message(str(recs[i].content), str(recs[i].sender), str(recs[i].timestamp)));
+    }
+    return result;
+}
+
+std::vector<UserResponse> SnapshotView::responses() const {
+    std::vector<UserResponse> result;
+    if (!header) return result;
+    const ResponseRec* recs = section<ResponseRec>(header->responses);
+    const StrRef* valueRefs = section<StrRef>(header->values);
+    for (uint64_t i = 0; i < header->responses.count; i++) {
+        if ((uint64_t)recs[i].firstValue + recs[i].valueCount > header->values.count) continue;
+        std::vector<std::string> responseValues;
+        for (uint32_t v = 0; v < recs[i].valueCount; v++) {
+            responseValues.push_back(str(valueRefs[recs[i].firstValue + v]));
+        }
+        result.push_back({str(recs[i].userId), str(recs[i].key), responseValues});
+    }
+    return result;
+}
+
+std::vector<std::string> SnapshotView::clearedUsers() const {
+    std::vector<std::string> result;
+    if (!header) return result;
+    const StrRef* refs = section<StrRef>(header->cleared);
+    for (uint64_t i = 0; i < header->cleared.count; i++) {
+        result.push_back(str(refs[i]));
+    }
+    return result;
+}
@@ -0,0 +1,142 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Message.h"
+#include "UserResponses.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// On-disk snapshot of in-memory state: AI sessions, the message history,
+// the per-user custom responses and users whose context was cleared. Every
+// section is a flat array of fixed-size records and strings are
+// {offset, length} into one pool, so the file is mmapped and read in place -
+// opening it costs the same whatever its size.
+namespace snapshot {
+
+struct StrRef {
+    uint32_t offset;        // into the string pool
+    uint32_t length;
+};
+
+struct Section {
+    uint64_t offset;        // from the start of the file
+    uint64_t count;
+};
+
+struct SessionRec {         // sorted by userId
+    StrRef userId;
+    StrRef summary;
+    uint32_t firstTurn;
+    uint32_t turnCount;
+};
+
+struct TurnRec {
+    StrRef role;
+    StrRef content;
+};
+
+struct MessageRec {
+    StrRef content;
+    StrRef sender;
+    StrRef timestamp;
+};
+
+struct ResponseRec {
+    StrRef userId;
+    StrRef key;
+    uint32_t firstValue;    // into the values section (StrRef[])
+    uint32_t valueCount;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerCrc;     // crc32 of the header with this field zeroed
+    uint64_t fileSize;
+    uint64_t walLsn;        // last message log record reflected here
+    uint64_t createdUnix;
+    Section sessions;
+    Section turns;
+    Section messages;
+    Section responses;
+    Section values;
+    Section cleared;        // StrRef[] of users whose sessions here are stale
+    Section strings;        // count = bytes
+};
+
+typedef std::vector<std::pair<std::string, std::string>> Turns;  // role, content
+
+} // namespace snapshot
+
+// Collects state and writes it as one snapshot file (tmp + fsync + rename)
+class SnapshotWriter {
+private:
+    struct PendingSession {
+        std::string userId;
+        snapshot::SessionRec rec;
+    };
+
+    std::vector<PendingSession> sessions;
+    std::vector<snapshot::TurnRec> turns;
+    std::vector<snapshot::MessageRec> messages;
+    std::vector<snapshot::ResponseRec> responses;
+    std::vector<snapshot::StrRef> values;
+    std::vector<snapshot::StrRef> cleared;
+    std::string strings;
+    bool overflow;          // a 32-bit offset would wrap; write() refuses
+
+    snapshot::StrRef intern(const std::string& s);
+    bool fits(size_t used, size_t more);
+
+public:
+    SnapshotWriter() : overflow(false) {}
+
+    void addSession(const std::string& userId, const std::string& summary, const snapshot::Turns& sessionTurns);
+    void addMessage(const Message& msg);
+    void addResponse(const UserResponse& response);
+    void addClearedUser(const std::string& userId);
+
+    size_t sessionCount() const { return sessions.size(); }
+    bool write(const std::string& path, uint64_t walLsn);
+};
+
+// Read-only mapping of a snapshot file
+class SnapshotView {
+private:
+    const char* base;
+    size_t size;
+    const snapshot::Header* header;
+
+    template <typename T>
+    const T* section(const snapshot::Section& s) const {
+        return reinterpret_cast<const T*>(base + s.offset);
+    }
+
+public:
+    SnapshotView();
+    ~SnapshotView();
+
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+
+    // Maps the file and validates header and section bounds
+    bool open(const std::string& path);
+
+    std::string str(const snapshot::StrRef& ref) const;
+    uint64_t walLsn() const { return header ? header->walLsn : 0; }
+    size_t bytes() const { return size; }
+
+    size_t sessionCount() const { return header ? header->sessions.count : 0; }
+    const snapshot::SessionRec& sessionAt(size_t i) const;
+    const snapshot::SessionRec* findSession(const std::string& userId) const;
+    snapshot::Turns turnsOf(const snapshot::SessionRec& session) const;
+
+    std::vector<Message> messages() const;
+    std::vector<UserResponse> responses() const;
+    std::vector<std::string> clearedUsers() const;
+};
+
+#endif // SNAPSHOT_H
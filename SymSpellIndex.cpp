@@ -0,0 +1,118 @@
+#include "SymSpellIndex.h"
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_set>
+
+SymSpellIndex::SymSpellIndex(int maxDistance, int prefixLength)
+    : maxDistance(maxDistance), prefixLength(prefixLength) {}
+
+uint64_t SymSpellIndex::hashVariant(const std::string& s) {
+    uint64_t h = 1469598103934665603ULL;  // FNV-1a
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// The word's prefix plus every string reachable by deleting up to
+// maxDistance characters from it (breadth first, no duplicates)
+void SymSpellIndex::collectDeletes(const std::string& word, int maxDistance, std::vector<std::string>& out) const {
+    std::string prefix = word.substr(0, prefixLength);
+    std::unordered_set<std::string> seen;
+    out.clear();
+    out.push_back(prefix);
+    seen.insert(prefix);
+    size_t levelStart = 0;
+    for (int d = 0; d < maxDistance; d++) {
+        size_t levelEnd = out.size();
+        for (size_t i = levelStart; i < levelEnd; i++) {
+            if (out[i].size() <= 1) continue;
+            for (size_t pos = 0; pos < out[i].size(); pos++) {
+                std::string shorter = out[i];
+                shorter.erase(pos, 1);
+                if (seen.insert(shorter).second) out.push_back(shorter);
+            }
+        }
+        levelStart = levelEnd;
+    }
+}
+
+void SymSpellIndex::add(const std::string& key) {
+    if (key.empty()) return;
+    std::vector<uint32_t>* exact = nullptr;
+    auto it = deletes.find(hashVariant(key.substr(0, prefixLength)));
+    if (it != deletes.end()) exact = &it->second;
+    if (exact) {
+        for (uint32_t id : *exact) {
+            if (keys[id] == key) return;  // already indexed
+        }
+    }
+
+    uint32_t id = (uint32_t)keys.size();
+    keys.push_back(key);
+    std::vector<std::string> variants;
+    collectDeletes(key, maxDistance, variants);
+    for (const auto& variant : variants) {
+        deletes[hashVariant(variant)].push_back(id);
+    }
+}
+
+bool SymSpellIndex::lookup(const std::string& word, int maxDistance, std::string& match, int& distance) const {
+    maxDistance = std::min(maxDistance, this->maxDistance);
+    if (word.empty() || keys.empty() || maxDistance < 0) return false;
+
+    std::vector<std::string> variants;
+    collectDeletes(word, maxDistance, variants);
+
+    int best = maxDistance + 1;
+    uint32_t bestId = 0;
+    std::unordered_set<uint32_t> checked;
+    for (const auto& variant : variants) {
+        auto it = deletes.find(hashVariant(variant));
+        if (it == deletes.end()) continue;
+        for (uint32_t id : it->second) {
+            if (!checked.insert(id).second) continue;
+            const std::string& key = keys[id];
+            int lengthGap = (int)key.size() - (int)word.size();
+            if (lengthGap > maxDistance || -lengthGap > maxDistance) continue;
+            int d = editDistance(word, key, std::min(best, maxDistance));
+            if (d < best || (d == best && id < bestId)) {
+                best = d;
+                bestId = id;
+            }
+        }
+    }
+    if (best > maxDistance) return false;
+    match = keys[bestId];
+    distance = best;
+    return true;
+}
+
+int SymSpellIndex::editDistance(const std::string& a, const std::string& b, int maxDistance) {
+    int n = (int)a.size(), m = (int)b.size();
+    if (std::abs(n - m) > maxDistance) return maxDistance + 1;
+
+    // Three rolling rows (transpositions look two back), reused across calls
+    static thread_local std::vector<int> prev2, prev, cur;
+    prev2.assign(m + 1, 0);
+    prev.resize(m + 1);
+    cur.resize(m + 1);
+    for (int j = 0; j <= m; j++) prev[j] = j;
+    for (int i = 1; i <= n; i++) {
+        cur[0] = i;
+        int rowMin = cur[0];
+        for (int j = 1; j <= m; j++) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            cur[j] = std::min(std::min(prev[j] + 1, cur[j - 1] + 1), prev[j - 1] + cost);
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                cur[j] = std::min(cur[j], prev2[j - 2] + 1);
+            }
+            rowMin = std::min(rowMin, cur[j]);
+        }
+        if (rowMin > maxDistance) return maxDistance + 1;
+        std::swap(prev2, prev);
+        std::swap(prev, cur);
+    }
+    return std::min(prev[m], maxDistance + 1);
+}
@@ -0,0 +1,39 @@
+#ifndef SYMSPELLINDEX_H
+#define SYMSPELLINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+// Typo-tolerant key lookup (symmetric delete). Every key is stored under
+// all variants with up to maxDistance characters deleted from its prefix;
+// a query generates the same deletes of itself, so candidates come from a
+// handful of hash probes and only those are checked with a bounded
+// Damerau-Levenshtein distance.
+class SymSpellIndex {
+public:
+    explicit SymSpellIndex(int maxDistance = 2, int prefixLength = 7);
+
+    void add(const std::string& key);
+    // Closest key within maxDistance edits (fewest edits, then first added); false if none
+    bool lookup(const std::string& word, int maxDistance, std::string& match, int& distance) const;
+
+    size_t size() const { return keys.size(); }
+    size_t variantCount() const { return deletes.size(); }
+
+    // Optimal string alignment distance, or maxDistance + 1 once it is exceeded
+    static int editDistance(const std::string& a, const std::string& b, int maxDistance);
+
+private:
+    int maxDistance;
+    int prefixLength;
+    std::vector<std::string> keys;
+    // Variants are keyed by hash; a collision only adds a candidate that fails verification
+    std::unordered_map<uint64_t, std::vector<uint32_t>> deletes;
+
+    static uint64_t hashVariant(const std::string& s);
+    void collectDeletes(const std::string& word, int maxDistance, std::vector<std::string>& out) const;
+};
+
+#endif // SYMSPELLINDEX_H
@@ -0,0 +1,123 @@
+#include "Tokenizer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Lowercase of a capital that encodes in two UTF-8 bytes (so does its
+// lowercase); anything else is returned unchanged
+static uint32_t foldCodepoint(uint32_t cp) {
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;                // Latin-1
+    if (cp >= 0x100 && cp <= 0x137) return cp | 1;                               // Latin Extended-A pairs
+    if (cp >= 0x139 && cp <= 0x148) return cp + (cp & 1);
+    if (cp >= 0x14A && cp <= 0x177) return cp | 1;
+    if (cp == 0x178) return 0xFF;
+    if (cp >= 0x179 && cp <= 0x17E) return cp + (cp & 1);
+    if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) return cp + 0x20;            // Greek
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;                            // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    return cp;
+}
+
+// Bytes in the UTF-8 sequence at p, or 1 if it is malformed or cut off
+static size_t sequenceLength(const unsigned char* p, size_t left) {
+    size_t n = p[0] < 0xC0 ? 1 : (p[0] < 0xE0 ? 2 : (p[0] < 0xF0 ? 3 : (p[0] < 0xF8 ? 4 : 1)));
+    if (n > left) return 1;
+    for (size_t k = 1; k < n; k++) {
+        if ((p[k] & 0xC0) != 0x80) return 1;
+    }
+    return n;
+}
+
+// Word characters: ASCII letters and digits, and any well-formed non-ASCII
+// character outside the punctuation and symbol blocks
+static bool isWordChar(const unsigned char* p, size_t n) {
+    if (n == 1) {
+        unsigned char c = p[0];
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+    }
+    if (n == 2) {
+        // Not Latin-1 punctuation or the multiply and divide signs
+        uint32_t cp = ((p[0] & 0x1Fu) << 6) | (p[1] & 0x3Fu);
+        return cp >= 0xC0 && cp != 0xD7 && cp != 0xF7;
+    }
+    if (n == 3) {
+        // Not general or CJK punctuation (curly quotes, dashes, ellipses)
+        uint32_t cp = ((p[0] & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+        return !(cp >= 0x2000 && cp <= 0x206F) && !(cp >= 0x3000 && cp <= 0x303F);
+    }
+    return true;
+}
+
+void Tokenizer::fold(char* text, size_t length) {
+    size_t i = 0;
+    bool ascii = true;
+#if defined(__SSE2__)
+    const __m128i beforeA = _mm_set1_epi8('A' - 1);
+    const __m128i afterZ = _mm_set1_epi8('Z' + 1);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    int high = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+        // Signed compares: bytes >= 0x80 are negative, so never in A..Z
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, beforeA), _mm_cmplt_epi8(v, afterZ));
+        _mm_storeu_si128((__m128i*)(text + i), _mm_or_si128(v, _mm_and_si128(upper, caseBit)));
+        high |= _mm_movemask_epi8(v);
+    }
+    ascii = high == 0;
+#endif
+    for (; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 'A' && c <= 'Z') text[i] = (char)(c | 0x20);
+        if (c >= 0x80) ascii = false;
+    }
+    if (ascii) return;
+
+    const unsigned char* p = (const unsigned char*)text;
+    for (i = 0; i < length;) {
+        size_t n = sequenceLength(p + i, length - i);
+        if (n == 2) {
+            uint32_t cp = foldCodepoint(((p[i] & 0x1Fu) << 6) | (p[i + 1] & 0x3Fu));
+            text[i] = (char)(0xC0 | (cp >> 6));
+            text[i + 1] = (char)(0x80 | (cp & 0x3F));
+        }
+        i += n;
+    }
+}
+
+void Tokenizer::tokenize(const char* text, size_t length) {
+    foldedText.assign(text, length);
+    fold(foldedText);
+
+    // Words plus single spaces never outgrow the input, so reserving up
+    // front keeps the views stable while joined is filled
+    joined.clear();
+    joined.reserve(length);
+    words.clear();
+
+    const unsigned char* p = (const unsigned char*)foldedText.data();
+    size_t start = std::string::npos;
+    for (size_t i = 0; i <= length;) {
+        size_t n = i < length ? sequenceLength(p + i, length - i) : 1;
+        bool word = i < length && isWordChar(p + i, n);
+        if (word && start == std::string::npos) {
+            start = i;
+        } else if (!word && start != std::string::npos) {
+            if (!joined.empty()) joined += ' ';
+            TokenView token;
+            token.data = joined.data() + joined.size();
+            token.size = (uint32_t)(i - start);
+            joined.append(foldedText, start, i - start);
+            words.push_back(token);
+            start = std::string::npos;
+        }
+        i += n;
+    }
+}
+
+bool Tokenizer::contains(const char* word) const {
+    for (const TokenView& token : words) {
+        if (token == word) return true;
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// A word inside a Tokenizer's buffer; valid until that Tokenizer is reused
+struct TokenView {
+    const char* data;
+    uint32_t size;
+
+    std::string str() const { return std::string(data, size); }
+    bool operator==(const char* word) const {
+        return std::strncmp(data, word, size) == 0 && word[size] == '\0';
+    }
+    bool operator==(const TokenView& other) const {
+        return size == other.size && std::memcmp(data, other.data, size) == 0;
+    }
+    bool operator<(const TokenView& other) const {
+        int c = std::memcmp(data, other.data, size < other.size ? size : other.size);
+        return c != 0 ? c < 0 : size < other.size;
+    }
+};
+
+// Normalizes one input and splits it into words. Case is folded for ASCII
+// (16 bytes at a time with SSE2) and for two-byte UTF-8 capitals (Latin-1,
+// Latin Extended-A, Greek, Cyrillic); ASCII punctuation, Latin-1 symbols and
+// UTF-8 general punctuation separate words. Buffers are kept between calls,
+// so once they have grown, tokenizing allocates nothing. Not copyable: the
+// views point into this object.
+class Tokenizer {
+public:
+    Tokenizer() {}
+    Tokenizer(const Tokenizer&) = delete;
+    Tokenizer& operator=(const Tokenizer&) = delete;
+
+    void tokenize(const char* text, size_t length);
+    void tokenize(const std::string& text) { tokenize(text.data(), text.size()); }
+
+    // Whole input with case folded, punctuation kept
+    const std::string& folded() const { return foldedText; }
+    // The words separated by single spaces
+    const std::string& phrase() const { return joined; }
+    const std::vector<TokenView>& tokens() const { return words; }
+    bool contains(const char* word) const;
+
+    // Folds case in place; the length never changes
+    static void fold(char* text, size_t length);
+    static void fold(std::string& text) { fold(&text[0], text.size()); }
+
+private:
+    std::string foldedText;
+    std::string joined;
+    std::vector<TokenView> words;
+};
+
+#endif // TOKENIZER_H
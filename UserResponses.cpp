@@ -0,0 +1,174 @@
+#include "UserResponses.h"
+#include "EpochReclaimer.h"
+#include <algorithm>
+#include <thread>
+
+UserResponses::UserResponses() : publishes(0), writes(0) {}
+
+UserResponses::~UserResponses() {
+    // Owners stop serving before destruction, so no reader is left
+    for (Shard& shard : shards) {
+        delete shard.current.load();
+    }
+}
+
+UserResponses::Shard& UserResponses::shardFor(const std::string& userId) {
+    return shards[std::hash<std::string>()(userId) % kShards];
+}
+
+const UserResponses::Shard& UserResponses::shardFor(const std::string& userId) const {
+    return shards[std::hash<std::string>()(userId) % kShards];
+}
+
+void UserResponses::add(const std::string& userId, const std::string& keyword, const std::string& response) {
+    apply(shardFor(userId), {{userId, keyword, {response}}});
+}
+
+std::vector<std::string> UserResponses::match(const std::string& userId, const Matcher& match) const {
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    const Table* table = shardFor(userId).current.load();
+    auto it = table->users.find(userId);
+    if (it == table->users.end()) return {};
+    return match(it->second->responses, it->second->fuzzy, it->second->ranked);
+}
+
+// Copies the table (pointers only) and rebuilds just the overlays the batch touches
+const UserResponses::Table* UserResponses::buildNext(const Table& current,
+                                                     const std::vector<UserResponse>& batch) const {
+    std::unordered_map<std::string, std::vector<const UserResponse*>> byUser;
+    for (const auto& entry : batch) {
+        byUser[entry.userId].push_back(&entry);
+    }
+
+    std::unique_ptr<Table> next(new Table(current));
+    for (const auto& user : byUser) {
+        auto it = current.users.find(user.first);
+        const Overlay* oldOverlay = it != current.users.end() ? it->second.get() : nullptr;
+        const ResponseMap* old = oldOverlay ? &oldOverlay->responses : nullptr;
+        int oldKeys = old ? old->getSize() : 0;
+        int buckets = (oldKeys + (int)user.second.size()) | 1;
+
+        std::shared_ptr<Overlay> overlay(new Overlay(buckets < kOverlayBuckets ? kOverlayBuckets : buckets));
+        if (old) {
+            for (const auto& key : old->getAllKeys()) {
+                for (const auto& value : old->get(key)) {
+                    overlay->responses.insert(key, value);
+                }
+            }
+        }
+        for (const UserResponse* entry : user.second) {
+            for (const auto& value : entry->values) {
+                overlay->responses.insert(entry->keyword, value);
+            }
+        }
+        // Typo variants and postings are precomputed here, off the lookup path;
+        // only new keys need them
+        if (oldOverlay) {
+            overlay->fuzzy = oldOverlay->fuzzy;
+            overlay->ranked = oldOverlay->ranked;
+        }
+        for (const UserResponse* entry : user.second) {
+            overlay->fuzzy.add(entry->keyword);
+            overlay->ranked.add(entry->keyword);
+        }
+        next->keys += overlay->responses.getSize() - oldKeys;
+        next->users[user.first] = overlay;
+    }
+    return next.release();
+}
+
+// Writers queue their entries; whoever finds no publisher running drains the
+// queue into one new version, so concurrent writers share a single copy
+void UserResponses::apply(Shard& shard, std::vector<UserResponse> batch) {
+    std::unique_lock<std::mutex> lock(shard.writeMutex);
+    for (auto& entry : batch) {
+        shard.pending.push_back(std::move(entry));
+    }
+    uint64_t ticket = ++shard.queued;
+
+    while (shard.applied < ticket) {
+        if (shard.publishing) {
+            shard.published.wait(lock);
+            continue;
+        }
+        shard.publishing = true;
+        std::vector<UserResponse> drained;
+        drained.swap(shard.pending);
+        uint64_t upTo = shard.queued;
+        lock.unlock();
+
+        const Table* old = shard.current.load();  // only the publisher replaces it
+        shard.current.store(buildNext(*old, drained));
+        EpochReclaimer::shared().retire([old]() { delete old; });
+        publishes++;
+        writes += (long long)drained.size();
+
+        lock.lock();
+        shard.applied = upTo;
+        shard.publishing = false;
+        shard.published.notify_all();
+    }
+}
+
+void UserResponses::merge(const std::vector<UserResponse>& entries, int threads) {
+    std::vector<std::vector<UserResponse>> byShard(kShards);
+    for (const auto& entry : entries) {
+        byShard[std::hash<std::string>()(entry.userId) % kShards].push_back(entry);
+    }
+
+    auto fillShards = [&](int t, int stride) {
+        for (int s = t; s < kShards; s += stride) {
+            if (!byShard[s].empty()) apply(shards[s], std::move(byShard[s]));
+        }
+    };
+
+    threads = std::max(1, std::min(threads, (int)kShards));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(fillShards, t, threads);
+    }
+    fillShards(0, threads);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::vector<UserResponse> UserResponses::exportAll() const {
+    std::vector<UserResponse> result;
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    for (const Shard& shard : shards) {
+        const Table* table = shard.current.load();
+        for (const auto& user : table->users) {
+            const ResponseMap& responses = user.second->responses;
+            for (const auto& key : responses.getAllKeys()) {
+                result.push_back({user.first, key, responses.get(key)});
+            }
+        }
+    }
+    return result;
+}
+
+size_t UserResponses::getUserCount() const {
+    size_t count = 0;
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    for (const Shard& shard : shards) {
+        count += shard.current.load()->users.size();
+    }
+    return count;
+}
+
+size_t UserResponses::getKeyCount() const {
+    size_t count = 0;
+    EpochReclaimer::Guard guard(EpochReclaimer::shared());
+    for (const Shard& shard : shards) {
+        count += shard.current.load()->keys;
+    }
+    return count;
+}
+
+UserResponses::Stats UserResponses::getStats() const {
+    Stats stats;
+    stats.publishes = publishes.load();
+    stats.writes = writes.load();
+    return stats;
+}
@@ -0,0 +1,92 @@
+#ifndef USERRESPONSES_H
+#define USERRESPONSES_H
+
+#include "HashMap.h"
+#include "SymSpellIndex.h"
+#include "ResponseIndex.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+// One user's responses for a keyword
+struct UserResponse {
+    std::string userId;
+    std::string keyword;
+    std::vector<std::string> values;
+};
+
+// Per-user response overlays, consulted before the shared built-in map.
+// Each shard publishes an immutable table through an atomic pointer: lookups
+// never lock or wait on a writer, and writes are batched into a
+// copy-on-write version that is swapped in and the old one retired to the
+// epoch reclaimer.
+class UserResponses {
+public:
+    typedef std::function<std::vector<std::string>(const ResponseMap&, const SymSpellIndex&, const ResponseIndex&)> Matcher;
+
+    struct Stats {
+        long long publishes;   // versions swapped in
+        long long writes;      // entries applied (publishes < writes = batching)
+    };
+
+    UserResponses();
+    ~UserResponses();
+
+    // Returns once the response is visible to lookups
+    void add(const std::string& userId, const std::string& keyword, const std::string& response);
+    // Runs match against the user's overlay; empty if the user has none
+    std::vector<std::string> match(const std::string& userId, const Matcher& match) const;
+    // Bulk insert: one version per shard, built on up to `threads` workers
+    void merge(const std::vector<UserResponse>& entries, int threads);
+    std::vector<UserResponse> exportAll() const;
+
+    size_t getUserCount() const;
+    size_t getKeyCount() const;
+    Stats getStats() const;
+
+private:
+    static const int kShards = 16;
+    static const int kOverlayBuckets = 7;  // most users add a handful of keywords
+
+    // One user's keywords plus the typo and BM25 indexes over them
+    struct Overlay {
+        ResponseMap responses;
+        SymSpellIndex fuzzy;
+        ResponseIndex ranked;
+        explicit Overlay(int buckets) : responses(buckets) {}
+    };
+
+    // Never modified once published; unchanged overlays are shared between versions
+    struct Table {
+        std::unordered_map<std::string, std::shared_ptr<const Overlay>> users;
+        size_t keys;
+        Table() : keys(0) {}
+    };
+
+    struct Shard {
+        std::atomic<const Table*> current;
+        std::mutex writeMutex;             // pending queue and publisher hand-off
+        std::condition_variable published;
+        std::vector<UserResponse> pending;
+        uint64_t queued;
+        uint64_t applied;
+        bool publishing;
+        Shard() : current(new Table()), queued(0), applied(0), publishing(false) {}
+    };
+
+    Shard shards[kShards];
+    std::atomic<long long> publishes;
+    std::atomic<long long> writes;
+
+    Shard& shardFor(const std::string& userId);
+    const Shard& shardFor(const std::string& userId) const;
+    void apply(Shard& shard, std::vector<UserResponse> batch);
+    const Table* buildNext(const Table& current, const std::vector<UserResponse>& batch) const;
+};
+
+#endif // USERRESPONSES_H
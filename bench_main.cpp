@@ -0,0 +1,450 @@
+#include "NewsParser.h"
+#include "Tokenizer.h"
+#include "ResponseIndex.h"
+#include "SemanticCache.h"
+#include "HashMap.h"
+#include "json.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+// Keeps benchmark results observable so the optimizer cannot drop the work
+static volatile size_t sink = 0;
+
+// Runs fn repeatedly for ~minMs and returns the mean time per call in microseconds
+static double timeIt(const std::function<void()>& fn, double minMs = 300.0) {
+    typedef std::chrono::steady_clock Clock;
+    fn();  // warm-up
+    long long iterations = 0;
+    auto start = Clock::now();
+    double elapsedMs = 0;
+    do {
+        fn();
+        iterations++;
+        elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    } while (elapsedMs < minMs);
+    return elapsedMs * 1000.0 / iterations;
+}
+
+static void report(const std::string& name, double usPerCall, size_t bytes) {
+    double mbPerSec = bytes / usPerCall;  // bytes per microsecond == MB/s
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << usPerCall << " us"
+              << std::setw(10) << std::setprecision(0) << mbPerSec << " MB/s\n";
+}
+
+// ========== NEWS PARSER ==========
+
+// Guardian /search page with the same shape as the live API
+static std::string makeGuardianPage(int articles) {
+    std::ostringstream o;
+    o << "{\"response\":{\"status\":\"ok\",\"userTier\":\"developer\",\"total\":" << articles * 40
+      << ",\"startIndex\":1,\"pageSize\":" << articles << ",\"currentPage\":1,\"pages\":40,"
+      << "\"orderBy\":\"newest\",\"results\":[";
+    const char* sections[] = {"World news", "Technology", "Sport", "Business", "Opinion"};
+    for (int i = 0; i < articles; i++) {
+        if (i > 0) o << ",";
+        o << "{\"id\":\"world/2024/jan/" << i << "/story-" << i << "\",\"type\":\"article\","
+          << "\"sectionId\":\"s" << i % 5 << "\",\"sectionName\":\"" << sections[i % 5] << "\","
+          << "\"webPublicationDate\":\"2024-01-" << (10 + i % 18) << "T12:00:00Z\","
+          << "\"webTitle\":\"Story " << i << ": the \\\"big\\\" question isn\\u2019t [settled], {yet}\","
+          << "\"webUrl\":\"https://www.theguardian.com/world/2024/jan/" << i << "/story-" << i << "\","
+          << "\"apiUrl\":\"https://content.guardianapis.com/world/2024/jan/" << i << "/story-" << i << "\","
+          << "\"fields\":{\"headline\":\"Story " << i << " headline\","
+          << "\"trailText\":\"A longer standfirst for story " << i
+          << " with enough text to look like a real trail, including commas, colons: and quotes\"},"
+          << "\"isHosted\":false,\"pillarId\":\"pillar/news\",\"pillarName\":\"News\"}";
+    }
+    o << "]}}";
+    return o.str();
+}
+
+// The find()-based scanner both news headers used before NewsParser
+static size_t legacyParse(const std::string& jsonResponse) {
+    size_t count = 0;
+    size_t pos = 0;
+    while ((pos = jsonResponse.find("\"webTitle\":\"", pos)) != std::string::npos) {
+        std::string title, url, section, date;
+        pos += 12;
+        size_t endPos = jsonResponse.find("\"", pos);
+        if (endPos != std::string::npos) title = jsonResponse.substr(pos, endPos - pos);
+        size_t urlPos = jsonResponse.find("\"webUrl\":\"", pos);
+        if (urlPos != std::string::npos) {
+            urlPos += 10;
+            url = jsonResponse.substr(urlPos, jsonResponse.find("\"", urlPos) - urlPos);
+        }
+        size_t secPos = jsonResponse.find("\"sectionName\":\"", pos);
+        if (secPos != std::string::npos) {
+            secPos += 15;
+            section = jsonResponse.substr(secPos, jsonResponse.find("\"", secPos) - secPos);
+        }
+        size_t datePos = jsonResponse.find("\"webPublicationDate\":\"", pos);
+        if (datePos != std::string::npos) {
+            datePos += 22;
+            date = jsonResponse.substr(datePos, jsonResponse.find("\"", datePos) - datePos);
+        }
+        count++;
+        pos = endPos;
+    }
+    return count;
+}
+
+static void benchNewsParser() {
+    std::cout << "\n== Guardian response parser ==\n";
+    for (int articles : {50, 200}) {
+        std::string page = makeGuardianPage(articles);
+        std::cout << articles << " articles (" << page.size() << " bytes)\n";
+
+        // Correctness against a full DOM parse
+        std::vector<NewsParser::ArticleRef> refs;
+        NewsParser::parse(page, refs);
+        json dom = json::parse(page);
+        const json& results = dom["response"]["results"];
+        bool ok = refs.size() == results.size();
+        for (size_t i = 0; ok && i < refs.size(); i++) {
+            ok = NewsParser::value(page, refs[i].title) == results[i]["webTitle"].get<std::string>() &&
+                 NewsParser::value(page, refs[i].url) == results[i]["webUrl"].get<std::string>() &&
+                 NewsParser::value(page, refs[i].trailText) == results[i]["fields"]["trailText"].get<std::string>();
+        }
+        std::cout << "  matches nlohmann::json: " << (ok ? "yes" : "NO") << "\n";
+
+        std::vector<uint32_t> positions;
+        report("stage 1 (structurals)", timeIt([&] {
+            NewsParser::scanStructurals(page.data(), page.size(), positions);
+        }), page.size());
+        report("NewsParser refs", timeIt([&] {
+            NewsParser::parse(page, refs);
+        }), page.size());
+        report("NewsParser + 4 fields", timeIt([&] {
+            NewsParser::parse(page, refs);
+            size_t total = 0;
+            for (const auto& r : refs) {
+                total += NewsParser::value(page, r.title).size() + NewsParser::value(page, r.url).size() +
+                         NewsParser::value(page, r.section).size() + NewsParser::value(page, r.date).size();
+            }
+            sink = total;
+        }), page.size());
+        report("legacy find() scanner", timeIt([&] {
+            sink = legacyParse(page);
+        }), page.size());
+        report("nlohmann::json DOM", timeIt([&] {
+            sink = json::parse(page).size();
+        }), page.size());
+    }
+}
+
+// ========== INPUT TOKENIZER ==========
+
+// How findBestResponse split input before Tokenizer
+static size_t legacySplit(const std::string& input) {
+    std::string lowerInput = input;
+    std::transform(lowerInput.begin(), lowerInput.end(), lowerInput.begin(), ::tolower);
+    std::istringstream iss(lowerInput);
+    std::vector<std::string> words;
+    std::string word;
+    while (iss >> word) {
+        words.push_back(word);
+    }
+    return words.size();
+}
+
+static void benchTokenizer() {
+    std::cout << "\n== Input tokenizer ==\n";
+    const std::string inputs[] = {
+        "Hey!! What's the LATEST news about the election?",
+        "Tell me a joke, then tell me about yourself: what can you do, and what is the weather like "
+        "where you are today? I'd also like the headlines on Technology, Sport and Business please.",
+        // French, Russian and Greek capitals, curly quotes and an em dash
+        "\xc3\x89" "COUTE, " "\xc3\x87" "A VA? \xe2\x80\x9c" "Caf\xc3\xa9\xe2\x80\x9d \xe2\x80\x94 "
+        "\xd0\x9f\xd0\xa0\xd0\x98\xd0\x92\xd0\x95\xd0\xa2 \xce\x9a\xce\x91\xce\x9b\xce\x97\xce\x9c\xce\x95\xce\xa1\xce\x91",
+    };
+    Tokenizer tokenizer;
+    for (const auto& input : inputs) {
+        tokenizer.tokenize(input);
+        std::cout << input.size() << " bytes -> " << tokenizer.tokens().size() << " words: \"" << tokenizer.phrase() << "\"\n";
+        report("Tokenizer (reused)", timeIt([&] {
+            tokenizer.tokenize(input);
+            sink = tokenizer.tokens().size();
+        }), input.size());
+        report("toLowerCase + istringstream", timeIt([&] {
+            sink = legacySplit(input);
+        }), input.size());
+    }
+}
+
+// ========== RESPONSE RETRIEVAL ==========
+
+// Synthetic words drawn with Zipf-like frequencies, so a few are in many
+// keys and most are rare, as in a real custom-response corpus
+class ZipfWords {
+public:
+    ZipfWords(int vocabulary, unsigned seed) : gen(seed) {
+        double total = 0;
+        for (int rank = 1; rank <= vocabulary; rank++) {
+            total += 1.0 / rank;
+            cdf.push_back(total);
+            std::string word;
+            for (int n = rank; n > 0; n /= 26) word += (char)('a' + n % 26);
+            words.push_back(word + "x");
+        }
+    }
+    const std::string& next() {
+        double u = std::uniform_real_distribution<double>(0, cdf.back())(gen);
+        return words[std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()];
+    }
+    std::mt19937& rng() { return gen; }
+
+private:
+    std::mt19937 gen;
+    std::vector<double> cdf;
+    std::vector<std::string> words;
+};
+
+// What findBestResponse did before BM25: the first input word that is a key,
+// else the first key containing (or contained in) a word
+static std::string legacyMatch(const ResponseMap& map, const std::vector<std::string>& words) {
+    for (const auto& w : words) {
+        if (map.contains(w)) return w;
+    }
+    std::vector<std::string> allKeys = map.getAllKeys();
+    for (const auto& w : words) {
+        for (const auto& key : allKeys) {
+            if (key.find(w) != std::string::npos || w.find(key) != std::string::npos) return key;
+        }
+    }
+    return "";
+}
+
+static void reportMatcher(const std::string& name, double usPerQuery, double top1) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << usPerQuery << " us"
+              << std::setw(9) << std::setprecision(1) << top1 * 100 << " % top-1\n";
+}
+
+static void benchResponseRetrieval() {
+    const int kKeys = 100000;
+    const int kQueries = 1000;
+    std::cout << "\n== Response retrieval (" << kKeys << " custom keys) ==\n";
+
+    // Keys of one to three distinct words
+    ZipfWords vocabulary(20000, 42);
+    std::vector<std::string> keys;
+    std::unordered_set<std::string> seen;
+    while ((int)keys.size() < kKeys) {
+        int length = 1 + (int)(vocabulary.rng()() % 3);
+        std::string key;
+        std::unordered_set<std::string> used;
+        while ((int)used.size() < length) {
+            const std::string& word = vocabulary.next();
+            if (used.insert(word).second) key += (key.empty() ? "" : " ") + word;
+        }
+        if (seen.insert(key).second) keys.push_back(key);
+    }
+
+    ResponseIndex index;
+    ResponseMap map(kKeys | 1);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& key : keys) index.add(key);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& key : keys) map.insert(key, "response");
+    std::cout << "  BM25 index build " << std::setprecision(1) << buildMs << " ms, "
+              << index.memoryBytes() / (1024.0 * 1024.0) << " MB\n";
+
+    // Each query is a key's words shuffled among three common filler words;
+    // the right answer is that key
+    std::vector<std::vector<std::string>> queries;
+    std::vector<std::string> queryText;
+    std::vector<const std::string*> targets;
+    for (int q = 0; q < kQueries; q++) {
+        const std::string& key = keys[vocabulary.rng()() % keys.size()];
+        std::vector<std::string> words = ResponseIndex::tokenize(key);
+        for (int f = 0; f < 3; f++) words.push_back(vocabulary.next());
+        std::shuffle(words.begin(), words.end(), vocabulary.rng());
+        queries.push_back(words);
+        std::string text;
+        for (const auto& word : words) text += (text.empty() ? "" : " ") + word;
+        queryText.push_back(text);
+        targets.push_back(&key);
+    }
+
+    // BM25 is timed from the raw text (tokenizing included); the legacy
+    // matcher gets its words pre-split
+    Tokenizer tokenizer;
+    int hits = 0;
+    for (int q = 0; q < kQueries; q++) {
+        std::string key;
+        double score = 0;
+        tokenizer.tokenize(queryText[q]);
+        hits += index.best(tokenizer.tokens(), key, score) && key == *targets[q];
+    }
+    size_t next = 0;
+    double bm25Us = timeIt([&] {
+        std::string key;
+        double score = 0;
+        tokenizer.tokenize(queryText[next++ % kQueries]);
+        index.best(tokenizer.tokens(), key, score);
+        sink = key.size();
+    });
+    reportMatcher("BM25 best key", bm25Us, (double)hits / kQueries);
+
+    hits = 0;
+    for (int q = 0; q < kQueries; q++) {
+        hits += legacyMatch(map, queries[q]) == *targets[q];
+    }
+    next = 0;
+    double legacyUs = timeIt([&] {
+        sink = legacyMatch(map, queries[next++ % kQueries]).size();
+    });
+    reportMatcher("first-hit word/partial", legacyUs, (double)hits / kQueries);
+}
+
+// ========== SEMANTIC CACHE ==========
+
+// Hand-labelled prompt pairs: paraphrases should hit, near misses must not
+static void benchSemanticPairs() {
+    const char* const paraphrases[][2] = {
+        {"What is your name?", "what's your name"},
+        {"tell me a joke", "Tell me a joke, please!"},
+        {"how do I cook rice", "how to cook rice"},
+        {"explain recursion", "could you explain recursion"},
+        {"What's the capital of France?", "what is the capital of france"},
+        {"who are you", "Who are you??"},
+        {"recommend a good book", "can you recommend a good book"},
+        {"what does HTTP stand for", "What does http stand for?"},
+    };
+    const char* const nearMisses[][2] = {
+        {"what is your name", "what is my name"},
+        {"what is 2+2", "what is 3+3"},
+        {"how do I cook rice", "how do I cook pasta"},
+        {"what's the capital of France", "what's the capital of Spain"},
+        {"I love you", "I don't love you"},
+        {"who wrote hamlet", "who wrote macbeth"},
+        {"translate hello to french", "translate hello to german"},
+        {"is it going to rain today", "is it going to rain tomorrow"},
+    };
+    float threshold = SemanticCache::Options().threshold;
+    float a[SemanticCache::kDimensions];
+    float b[SemanticCache::kDimensions];
+    int hits = 0;
+    for (const auto& pair : paraphrases) {
+        SemanticCache::embed(pair[0], a);
+        SemanticCache::embed(pair[1], b);
+        hits += SemanticCache::dot(a, b) >= threshold;
+    }
+    int falseHits = 0;
+    float worst = -1.0f;
+    for (const auto& pair : nearMisses) {
+        SemanticCache::embed(pair[0], a);
+        SemanticCache::embed(pair[1], b);
+        float similarity = SemanticCache::dot(a, b);
+        falseHits += similarity >= threshold;
+        worst = std::max(worst, similarity);
+    }
+    std::cout << "  at threshold " << std::setprecision(2) << threshold << ": " << hits << "/"
+              << sizeof(paraphrases) / sizeof(paraphrases[0]) << " paraphrases hit, " << falseHits << "/"
+              << sizeof(nearMisses) / sizeof(nearMisses[0]) << " near misses hit (highest similarity "
+              << worst << ")\n";
+}
+
+static void reportSearch(const std::string& name, double usPerLookup, double recall) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << usPerLookup << " us"
+              << std::setw(9) << std::setprecision(1) << recall * 100 << " % of hits\n";
+}
+
+static void benchSemanticCache() {
+    const int kEntries = 20000;
+    const int kQueries = 1000;
+    const int kLists = 128;
+    std::cout << "\n== Semantic cache (" << kEntries << " cached prompts) ==\n";
+    benchSemanticPairs();
+
+    // Prompts of four to eight words; each query rephrases one of them the
+    // way people do: filler words around it and sometimes a typo
+    ZipfWords vocabulary(20000, 7);
+    std::vector<std::string> prompts;
+    for (int i = 0; i < kEntries; i++) {
+        int length = 4 + (int)(vocabulary.rng()() % 5);
+        std::string prompt;
+        for (int w = 0; w < length; w++) prompt += (prompt.empty() ? "" : " ") + vocabulary.next();
+        prompts.push_back(prompt);
+    }
+    const char* const fillers[] = {"please", "can", "the", "tell", "me", "a", "is"};
+    std::vector<std::string> queries;
+    for (int q = 0; q < kQueries; q++) {
+        std::mt19937& rng = vocabulary.rng();
+        std::vector<std::string> words = ResponseIndex::tokenize(prompts[rng() % kEntries]);
+        for (int f = 0; f < 2; f++) words.insert(words.begin() + rng() % (words.size() + 1), fillers[rng() % 7]);
+        std::string& typo = words[rng() % words.size()];
+        if (q % 2 == 0 && typo.size() > 3) std::swap(typo[1], typo[2]);
+        std::string query;
+        for (const auto& word : words) query += (query.empty() ? "" : " ") + word;
+        queries.push_back(query);
+    }
+
+    // Recall: of the hits a flat scan finds, the share IVF finds too
+    SemanticCache::Options options;
+    options.maxEntries = kEntries;
+    options.lists = kLists;
+    SemanticCache cache(options);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kEntries; i++) cache.put(0, prompts[i], std::to_string(i), 0);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  build (embed + k-means + assign) " << std::setprecision(1) << buildMs << " ms, "
+              << cache.getStats().memoryBytes / (1024.0 * 1024.0) << " MB\n";
+
+    // Flat scan: what the cache does before training, and the ground truth
+    std::vector<std::string> truth(kQueries);
+    SemanticCache::Options flatOptions = options;
+    flatOptions.lists = 1;
+    SemanticCache flat(flatOptions);
+    for (int i = 0; i < kEntries; i++) flat.put(0, prompts[i], std::to_string(i), 0);
+    int flatHits = 0;
+    for (int q = 0; q < kQueries; q++) flatHits += flat.get(0, queries[q], truth[q]);
+    std::cout << "  " << flatHits * 100 / kQueries << " % of rephrased queries hit at threshold "
+              << std::setprecision(2) << options.threshold << "\n";
+    size_t next = 0;
+    double flatUs = timeIt([&] {
+        std::string answer;
+        flat.get(0, queries[next++ % kQueries], answer);
+        sink = answer.size();
+    });
+    reportSearch("flat scan", flatUs, 1.0);
+
+    for (int probes : {1, 2, 4, 8, 16}) {
+        options.probes = probes;
+            SemanticCache probed(options);
+        for (int i = 0; i < kEntries; i++) probed.put(0, prompts[i], std::to_string(i), 0);
+        int found = 0;
+        for (int q = 0; q < kQueries; q++) {
+            std::string answer;
+            found += probed.get(0, queries[q], answer) && answer == truth[q];
+        }
+        next = 0;
+        double us = timeIt([&] {
+            std::string answer;
+            probed.get(0, queries[next++ % kQueries], answer);
+            sink = answer.size();
+        });
+        reportSearch("IVF " + std::to_string(kLists) + " lists, " + std::to_string(probes) + " probes", us,
+                     flatHits > 0 ? (double)found / flatHits : 0.0);
+    }
+}
+
+int main() {
+    std::cout << "Chatbot micro-benchmarks\n";
+    benchNewsParser();
+    benchTokenizer();
+    benchResponseRetrieval();
+    benchSemanticCache();
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
 
 // Configuration file reader
 struct Config {
@@ -10,9 +11,23 @@ struct Config {
     std::string groqApiKey;
     std::string groqModel;
     int port;
+    ServerOptions server;
     
     Config() : port(8080), groqModel("llama-3.3-70b-versatile") {}
     
+    // Worker counts, limits and sizes: values below min are reported and the
+    // default kept, rather than wrapping around when converted to size_t
+    template <typename T>
+    static bool readCount(const std::string& key, const std::string& value, T& field, int min = 0) {
+        int parsed = std::stoi(value);
+        if (parsed < min) {
+            std::cerr << "[Config] Ignoring " << key << "=" << value << " (must be at least " << min << ")" << std::endl;
+            return false;
+        }
+        field = (T)parsed;
+        return true;
+    }
+    
     bool loadFromFile(const std::string& filename) {
         std::ifstream file(filename);
         if (!file.is_open()) {
@@ -44,6 +59,73 @@ struct Config {
                     groqApiKey = value;
                 } else if (key == "Groq_Model") {
                     groqModel = value;
+                } else if (key == "THREAD_POOL_SIZE") {
+                    readCount(key, value, server.threadPoolSize, 1);
+                } else if (key == "MAX_QUEUED_CONNECTIONS") {
+                    readCount(key, value, server.maxQueuedConnections);
+                } else if (key == "KEEP_ALIVE_MAX_COUNT") {
+                    readCount(key, value, server.keepAliveMaxCount, 1);
+                } else if (key == "KEEP_ALIVE_TIMEOUT") {
+                    server.keepAliveTimeoutSec = std::stoi(value);
+                } else if (key == "READ_TIMEOUT") {
+                    server.readTimeoutSec = std::stoi(value);
+                } else if (key == "WRITE_TIMEOUT") {
+                    server.writeTimeoutSec = std::stoi(value);
+                } else if (key == "MAX_INFLIGHT_CHATS") {
+                    readCount(key, value, server.maxInflightChats, 1);
+                } else if (key == "RESERVED_WORKERS") {
+                    readCount(key, value, server.reservedWorkers);
+                } else if (key == "RESPONSE_CACHE_ENTRIES") {
+                    readCount(key, value, server.responseCacheEntries);
+                } else if (key == "RESPONSE_CACHE_TTL") {
+                    server.responseCacheTtlSec = std::stoi(value);
+                } else if (key == "SEMANTIC_CACHE_ENTRIES") {
+                    readCount(key, value, server.semanticCache.maxEntries);
+                } else if (key == "SEMANTIC_CACHE_THRESHOLD") {
+                    server.semanticCache.threshold = std::stof(value);
+                } else if (key == "SEMANTIC_CACHE_LISTS") {
+                    readCount(key, value, server.semanticCache.lists, 1);
+                } else if (key == "SEMANTIC_CACHE_PROBES") {
+                    readCount(key, value, server.semanticCache.probes, 1);
+                } else if (key == "CONTEXT_TOKEN_BUDGET") {
+                    readCount(key, value, server.contextTokenBudget, 1);
+                } else if (key == "CONTEXT_COMPACT_TOKENS") {
+                    readCount(key, value, server.contextCompactTokens);
+                } else if (key == "CHAT_DEADLINE_MS") {
+                    server.chatDeadlineMs = std::stoi(value);
+                } else if (key == "WAL_DIR") {
+                    server.wal.directory = value;
+                } else if (key == "WAL_SEGMENT_MB") {
+                    size_t megabytes = 0;
+                    if (readCount(key, value, megabytes, 1)) server.wal.segmentBytes = megabytes << 20;
+                } else if (key == "WAL_GROUP_COMMIT_MS") {
+                    server.wal.groupCommitMs = std::stoi(value);
+                } else if (key == "SNAPSHOT_PATH") {
+                    server.snapshotPath = value;
+                } else if (key == "RESPONSE_CORPUS_PATH") {
+                    server.responseCorpusPath = value;
+                } else if (key == "SNAPSHOT_INTERVAL") {
+                    server.snapshotIntervalSec = std::stoi(value);
+                } else if (key == "HEDGE_REQUESTS") {
+                    server.hedgeRequests = (value == "true" || value == "1");
+                } else if (key == "NEWS_CACHE_TTL") {
+                    server.news.ttlSec = std::stoi(value);
+                } else if (key == "NEWS_STALE_TTL") {
+                    server.news.staleSec = std::stoi(value);
+                } else if (key == "NEWS_REFRESH_INTERVAL") {
+                    server.news.refreshIntervalSec = std::stoi(value);
+                } else if (key == "NEWS_CACHE_ENTRIES") {
+                    readCount(key, value, server.news.maxEntries, 1);
+                } else if (key == "NEWS_POPULAR_KEYWORDS") {
+                    server.news.popularKeywords = std::stoi(value);
+                } else if (key == "NEWS_PREFETCH_SECTIONS") {
+                    // Comma-separated list, e.g. world,technology,sport
+                    server.news.sections.clear();
+                    std::stringstream ss(value);
+                    std::string section;
+                    while (std::getline(ss, section, ',')) {
+                        if (!section.empty()) server.news.sections.push_back(section);
+                    }
                 }
             }
         }
@@ -79,7 +161,7 @@ int main() {
     
     // Initialize and start API Server
     APIServer server(config.port, config.firebaseUrl, config.firebaseKey, 
-                     config.groqApiKey, config.groqModel);
+                     config.groqApiKey, config.groqModel, config.server);
     
     // server.start() is blocking, so this will keep the process running
     server.start();